@@ -24,9 +24,31 @@
 #include <optional>
 #include <charconv>
 #include <mutex>
+#include <memory>
 #include <condition_variable>
 #include <thread>
 #include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <iomanip>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <immintrin.h>
+#endif
 
 enum class EUserAction
 {
@@ -35,6 +57,7 @@ enum class EUserAction
     CANCEL,
     MODIFY,
     PRINT,
+    MEMORY,
     EXIT
 };
 
@@ -50,6 +73,398 @@ enum class ETransactType
     SELL
 };
 
+// How the matching thread waits for new commands.
+// BLOCKING sleeps on the condition variable and costs a futex wake per command.
+// SPIN_THEN_YIELD polls for a bounded number of iterations before yielding the core.
+// BUSY_POLL never gives up the core, trading a full CPU for the lowest wake-up latency.
+enum class EWaitStrategy
+{
+    BLOCKING,
+    SPIN_THEN_YIELD,
+    BUSY_POLL
+};
+
+// What CreateTransaction does when a resting order cap is reached.
+// BACKPRESSURE blocks the caller until matching or cancels free a slot, up to backpressureTimeout.
+enum class ECapacityPolicy
+{
+    REJECT,
+    BACKPRESSURE
+};
+
+enum class ECreateResult
+{
+    ACCEPTED,
+    DUPLICATE,
+    REJECTED
+};
+
+struct MarketOptions
+{
+    int matchThreadCpu = -1; // -1 leaves the thread to the OS scheduler
+    int ioThreadCpu = -1;    // Applied by the caller to its own I/O thread, see PinCurrentThreadToCpu
+    EWaitStrategy waitStrategy = EWaitStrategy::BLOCKING;
+    int spinIterations = 4096; // Only used by SPIN_THEN_YIELD
+
+    // Cancelled orders are tombstoned and dropped lazily, either once they make up
+    // compactDeadRatio of the book (and at least compactMinDead entries) or when the
+    // matching thread has been idle for idleCompactInterval.
+    double compactDeadRatio = 0.5;
+    size_t compactMinDead = 64;
+    std::chrono::milliseconds idleCompactInterval{ 100 };
+
+    // Caps on live resting orders, 0 means unlimited. A new order counts against the cap
+    // from the moment it enters the book, before its matching pass.
+    size_t maxRestingOrders = 0;
+    size_t maxRestingOrdersPerSide = 0;
+    ECapacityPolicy capacityPolicy = ECapacityPolicy::REJECT;
+    std::chrono::milliseconds backpressureTimeout{ 1000 };
+};
+
+// Estimated heap footprint of a book. Byte counts are computed from the library's
+// object sizes rather than measured, so treat them as a close lower bound.
+struct MarketMemoryUsage
+{
+    size_t restingBuys = 0;
+    size_t restingSells = 0;
+    size_t tombstones = 0;
+    size_t rejected = 0;
+    size_t orderBytes = 0;    // Book slots, Transaction objects, shared_ptr control blocks and order ID heap buffers
+    size_t indexBytes = 0;    // Order ID index nodes and their key buffers
+    size_t reservedBytes = 0; // Spare book capacity and index buckets
+    size_t queueBytes = 0;    // Producer rings
+
+    size_t TotalBytes() const { return orderBytes + indexBytes + reservedBytes + queueBytes; }
+};
+
+// Returns false when the platform does not support pinning or the CPU index is invalid.
+bool PinCurrentThreadToCpu(int cpu)
+{
+    if (cpu < 0)
+    {
+        return false;
+    }
+#if defined(_WIN32)
+    if (cpu >= static_cast<int>(sizeof(DWORD_PTR) * CHAR_BIT))
+    {
+        return false;
+    }
+    return SetThreadAffinityMask(GetCurrentThread(), static_cast<DWORD_PTR>(1) << cpu) != 0;
+#elif defined(__linux__)
+    if (cpu >= CPU_SETSIZE)
+    {
+        return false;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    return false;
+#endif
+}
+
+// Hint to the core that we are in a spin loop, so a sibling hyper-thread is not starved.
+inline void CpuRelax()
+{
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    _mm_pause();
+#endif
+}
+
+// Operations timed by the optional perf instrumentation, see PerfRecorder.
+enum class EPerfOperation
+{
+    CREATE,
+    CANCEL,
+    MODIFY,
+    MATCH,
+    MATCH_ORDERS,
+    PRINT,
+    COMPACT,
+    COUNT
+};
+
+const char* ToString(EPerfOperation operation)
+{
+    switch (operation)
+    {
+    case EPerfOperation::CREATE: return "create";
+    case EPerfOperation::CANCEL: return "cancel";
+    case EPerfOperation::MODIFY: return "modify";
+    case EPerfOperation::MATCH: return "match";
+    case EPerfOperation::MATCH_ORDERS: return "match_orders";
+    case EPerfOperation::PRINT: return "print";
+    case EPerfOperation::COMPACT: return "compact";
+    default: return "unknown";
+    }
+}
+
+struct PerfSample
+{
+    uint64_t cycles = 0;
+    uint64_t instructions = 0;
+    uint64_t cacheMisses = 0;
+    uint64_t branchMisses = 0;
+};
+
+// Hardware counters for the calling thread, opened lazily on first use through perf_event_open.
+// On other platforms, or when the kernel refuses (perf_event_paranoid, containers, VMs without a PMU),
+// IsAvailable is false and callers fall back to wall clock only.
+class PerfCounterGroup
+{
+public:
+    static PerfCounterGroup& ForCurrentThread()
+    {
+        thread_local PerfCounterGroup group;
+        return group;
+    }
+
+    bool IsAvailable() const { return m_LeaderFd >= 0; }
+
+    bool Read(PerfSample& sample) const
+    {
+#if defined(__linux__)
+        if (!IsAvailable())
+        {
+            return false;
+        }
+
+        // PERF_FORMAT_GROUP layout: number of counters, then one value per counter in open order
+        uint64_t buffer[1 + kEventCount] = {};
+        if (read(m_LeaderFd, buffer, sizeof(buffer)) <= 0)
+        {
+            return false;
+        }
+
+        uint64_t* values[kEventCount] = { &sample.cycles, &sample.instructions, &sample.cacheMisses, &sample.branchMisses };
+        for (int i = 0; i < kEventCount; ++i)
+        {
+            if (m_Slots[i] >= 0 && static_cast<uint64_t>(m_Slots[i]) < buffer[0])
+            {
+                *values[i] = buffer[1 + m_Slots[i]];
+            }
+        }
+        return true;
+#else
+        (void)sample;
+        return false;
+#endif
+    }
+
+    PerfCounterGroup(const PerfCounterGroup&) = delete;
+    PerfCounterGroup& operator=(const PerfCounterGroup&) = delete;
+
+private:
+    static constexpr int kEventCount = 4;
+
+    PerfCounterGroup()
+    {
+#if defined(__linux__)
+        const uint64_t configs[kEventCount] = {
+            PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES };
+
+        int opened = 0;
+        for (int i = 0; i < kEventCount; ++i)
+        {
+            int fd = OpenEvent(configs[i], m_LeaderFd);
+            if (fd < 0)
+            {
+                // Cycles lead the group, without them the other counters are not read at all
+                if (i == 0)
+                {
+                    return;
+                }
+                continue;
+            }
+
+            if (i == 0)
+            {
+                m_LeaderFd = fd;
+            }
+            m_Fds[i] = fd;
+            m_Slots[i] = opened++;
+        }
+#endif
+    }
+
+    ~PerfCounterGroup()
+    {
+#if defined(__linux__)
+        for (int fd : m_Fds)
+        {
+            if (fd >= 0)
+            {
+                close(fd);
+            }
+        }
+#endif
+    }
+
+#if defined(__linux__)
+    static int OpenEvent(uint64_t config, int groupFd)
+    {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = config;
+        attr.read_format = PERF_FORMAT_GROUP;
+        attr.exclude_kernel = 1; // User space only, allowed at the default perf_event_paranoid level
+        attr.exclude_hv = 1;
+        return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, groupFd, 0));
+    }
+#endif
+
+    int m_LeaderFd = -1;
+    int m_Fds[kEventCount] = { -1, -1, -1, -1 };
+    int m_Slots[kEventCount] = { -1, -1, -1, -1 }; // Position in the group read, -1 when the event is unsupported
+};
+
+// Process-wide per-operation totals. Disabled by default, so an instrumented operation
+// only pays for one relaxed load when nobody is benchmarking.
+class PerfRecorder
+{
+public:
+    static PerfRecorder& Get()
+    {
+        static PerfRecorder recorder;
+        return recorder;
+    }
+
+    void SetEnabled(bool enabled) { m_Enabled.store(enabled, std::memory_order_relaxed); }
+    bool IsEnabled() const { return m_Enabled.load(std::memory_order_relaxed); }
+
+    void Reset()
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        for (auto& totals : m_Totals)
+        {
+            totals = Totals();
+        }
+    }
+
+    void Record(EPerfOperation operation, const PerfSample* counters, std::chrono::nanoseconds wall)
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        Totals& totals = m_Totals[static_cast<int>(operation)];
+        ++totals.calls;
+        totals.wallNs += static_cast<uint64_t>(wall.count());
+        if (counters != nullptr)
+        {
+            ++totals.sampledCalls;
+            totals.counters.cycles += counters->cycles;
+            totals.counters.instructions += counters->instructions;
+            totals.counters.cacheMisses += counters->cacheMisses;
+            totals.counters.branchMisses += counters->branchMisses;
+        }
+    }
+
+    void Report(std::ostream& out) const
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        bool anyCounters = false;
+        out << std::left << std::setw(14) << "operation" << std::right
+            << std::setw(10) << "calls" << std::setw(12) << "ns/op" << std::setw(12) << "cycles/op"
+            << std::setw(12) << "instr/op" << std::setw(8) << "IPC" << std::setw(14) << "cache-miss/op"
+            << std::setw(15) << "branch-miss/op" << std::endl;
+
+        for (int i = 0; i < static_cast<int>(EPerfOperation::COUNT); ++i)
+        {
+            const Totals& totals = m_Totals[i];
+            if (totals.calls == 0)
+            {
+                continue;
+            }
+
+            out << std::left << std::setw(14) << ToString(static_cast<EPerfOperation>(i)) << std::right
+                << std::setw(10) << totals.calls
+                << std::setw(12) << std::fixed << std::setprecision(0) << static_cast<double>(totals.wallNs) / totals.calls;
+
+            if (totals.sampledCalls == 0)
+            {
+                out << std::setw(12) << "n/a" << std::setw(12) << "n/a" << std::setw(8) << "n/a"
+                    << std::setw(14) << "n/a" << std::setw(15) << "n/a" << std::endl;
+                continue;
+            }
+
+            anyCounters = true;
+            const double calls = static_cast<double>(totals.sampledCalls);
+            const PerfSample& c = totals.counters;
+            out << std::setprecision(0) << std::setw(12) << c.cycles / calls << std::setw(12) << c.instructions / calls
+                << std::setprecision(2) << std::setw(8) << (c.cycles != 0 ? static_cast<double>(c.instructions) / c.cycles : 0.0)
+                << std::setw(14) << c.cacheMisses / calls << std::setw(15) << c.branchMisses / calls << std::endl;
+        }
+
+        if (!anyCounters)
+        {
+            out << "hardware counters unavailable, wall clock only" << std::endl;
+        }
+    }
+
+private:
+    struct Totals
+    {
+        uint64_t calls = 0;
+        uint64_t sampledCalls = 0;
+        uint64_t wallNs = 0;
+        PerfSample counters;
+    };
+
+    std::atomic<bool> m_Enabled{ false };
+    mutable std::mutex m_Mutex;
+    Totals m_Totals[static_cast<int>(EPerfOperation::COUNT)];
+};
+
+// Measures the enclosing block on the current thread when the recorder is enabled.
+class PerfScope
+{
+public:
+    explicit PerfScope(EPerfOperation operation)
+        : m_Operation(operation), m_Active(PerfRecorder::Get().IsEnabled())
+    {
+        if (m_Active)
+        {
+            m_HasCounters = PerfCounterGroup::ForCurrentThread().Read(m_Start);
+            m_StartTime = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~PerfScope()
+    {
+        if (!m_Active)
+        {
+            return;
+        }
+
+        auto wall = std::chrono::steady_clock::now() - m_StartTime;
+        PerfSample end;
+        if (m_HasCounters && PerfCounterGroup::ForCurrentThread().Read(end))
+        {
+            PerfSample delta;
+            delta.cycles = end.cycles - m_Start.cycles;
+            delta.instructions = end.instructions - m_Start.instructions;
+            delta.cacheMisses = end.cacheMisses - m_Start.cacheMisses;
+            delta.branchMisses = end.branchMisses - m_Start.branchMisses;
+            PerfRecorder::Get().Record(m_Operation, &delta, std::chrono::duration_cast<std::chrono::nanoseconds>(wall));
+        }
+        else
+        {
+            PerfRecorder::Get().Record(m_Operation, nullptr, std::chrono::duration_cast<std::chrono::nanoseconds>(wall));
+        }
+    }
+
+    PerfScope(const PerfScope&) = delete;
+    PerfScope& operator=(const PerfScope&) = delete;
+
+private:
+    EPerfOperation m_Operation;
+    bool m_Active;
+    bool m_HasCounters = false;
+    PerfSample m_Start;
+    std::chrono::steady_clock::time_point m_StartTime;
+};
+
 class Transaction
 {
 public:
@@ -66,7 +481,7 @@ public:
 
     }
 
-    std::string GetOrderID() const { return m_OrderID; }
+    const std::string& GetOrderID() const { return m_OrderID; }
     ETransactType GetTransactionType() const { return m_TransactionType; }
     EOrderType GetOrderType() const { return m_OrderType; }
     int GetPrice() const { return m_Price; }
@@ -77,268 +492,893 @@ public:
         return m_OrderType != EOrderType::IOC;
     }
 
-    void Modify(ETransactType transactionType, int price, int quantity)
+    void Modify(ETransactType transactionType, int price, int quantity)
+    {
+        m_TransactionType = transactionType;
+        m_Price = price;
+        m_Quantity = quantity;
+    }
+
+    void UpdateQuantity(int tradedQuantity)
+    {
+        m_Quantity -= tradedQuantity;
+    }
+
+    // Tombstone, the matcher skips the order and the next compaction drops it from the book.
+    bool IsCancelled() const { return m_IsCancelled.load(std::memory_order_acquire); }
+    void MarkCancelled() { m_IsCancelled.store(true, std::memory_order_release); }
+
+private:
+    ETransactType m_TransactionType;
+    EOrderType m_OrderType;
+    int m_Price;
+    int m_Quantity;
+    std::string m_OrderID;
+    std::atomic<bool> m_IsCancelled{ false }; // Not copied, a copy is always a live order
+};
+
+// A command stamped with its global arrival order, as queued by a TransactionMarket::Producer.
+struct MarketCommand
+{
+    uint64_t sequence = 0;
+    EUserAction action = EUserAction::BUY;
+    ETransactType transactType = ETransactType::BUY;
+    EOrderType orderType = EOrderType::GFD;
+    int price = 0;
+    int quantity = 0;
+    std::string orderID;
+};
+
+// Bounded lock-free ring for exactly one producer thread and one consumer thread.
+// Each side caches the other's index so it only touches the shared cache line when it looks full or empty.
+template <typename T>
+class SpscQueue
+{
+public:
+    explicit SpscQueue(size_t capacity)
+    {
+        size_t size = 1;
+        while (size < capacity)
+        {
+            size <<= 1;
+        }
+        m_Buffer.resize(size);
+        m_Mask = size - 1;
+    }
+
+    // Moves from value only on success.
+    bool TryPush(T& value)
+    {
+        const size_t tail = m_Tail.load(std::memory_order_relaxed);
+        if (tail - m_CachedHead == m_Buffer.size())
+        {
+            m_CachedHead = m_Head.load(std::memory_order_acquire);
+            if (tail - m_CachedHead == m_Buffer.size())
+            {
+                return false;
+            }
+        }
+        m_Buffer[tail & m_Mask] = std::move(value);
+        m_Tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Returns nullptr when empty. Consumer only.
+    T* Front()
+    {
+        const size_t head = m_Head.load(std::memory_order_relaxed);
+        if (head == m_CachedTail)
+        {
+            m_CachedTail = m_Tail.load(std::memory_order_acquire);
+            if (head == m_CachedTail)
+            {
+                return nullptr;
+            }
+        }
+        return &m_Buffer[head & m_Mask];
+    }
+
+    size_t Capacity() const { return m_Buffer.size(); }
+
+    // Consumer only, must follow a successful Front.
+    void Pop()
+    {
+        m_Head.store(m_Head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+private:
+    std::vector<T> m_Buffer;
+    size_t m_Mask = 0;
+
+    alignas(64) std::atomic<size_t> m_Head{ 0 }; // Written by the consumer
+    size_t m_CachedTail = 0;
+    alignas(64) std::atomic<size_t> m_Tail{ 0 }; // Written by the producer
+    size_t m_CachedHead = 0;
+};
+
+class TransactionMarket
+{
+public:
+    // Submission handle for one feed handler thread. Each producer owns a private queue,
+    // so producers never contend with each other or on m_Mutex. Commands are stamped from
+    // a global sequence and the matching thread applies them strictly in stamp order, one
+    // matching pass per command, so the trades only depend on the stamped input.
+    // A producer must be used from a single thread and must not outlive its market.
+    class Producer
+    {
+    public:
+        void CreateTransaction(ETransactType transactType, EOrderType orderType, int price, int quantity, std::string orderID)
+        {
+            MarketCommand command;
+            command.action = transactType == ETransactType::BUY ? EUserAction::BUY : EUserAction::SELL;
+            command.transactType = transactType;
+            command.orderType = orderType;
+            command.price = price;
+            command.quantity = quantity;
+            command.orderID = std::move(orderID);
+            Submit(command);
+        }
+
+        void CancelTransaction(std::string orderID)
+        {
+            MarketCommand command;
+            command.action = EUserAction::CANCEL;
+            command.orderID = std::move(orderID);
+            Submit(command);
+        }
+
+        void ModifyTransaction(std::string orderID, ETransactType transactType, int newPrice, int newQuantity)
+        {
+            MarketCommand command;
+            command.action = EUserAction::MODIFY;
+            command.transactType = transactType;
+            command.price = newPrice;
+            command.quantity = newQuantity;
+            command.orderID = std::move(orderID);
+            Submit(command);
+        }
+
+    private:
+        friend class TransactionMarket;
+        Producer(TransactionMarket* market, SpscQueue<MarketCommand>* queue) : m_Market(market), m_Queue(queue) {}
+
+        void Submit(MarketCommand& command)
+        {
+            command.sequence = m_Market->m_NextStamp.fetch_add(1, std::memory_order_relaxed);
+
+            // Backpressure: the matcher is behind on this producer, wait for it to drain a slot.
+            // Spin rather than block, the stamp is already taken and holds back every later one.
+            while (!m_Queue->TryPush(command))
+            {
+                CpuRelax();
+            }
+            m_Market->NotifyIngest();
+        }
+
+        TransactionMarket* m_Market;
+        SpscQueue<MarketCommand>* m_Queue;
+    };
+
+    TransactionMarket() : TransactionMarket(MarketOptions()) {}
+
+    explicit TransactionMarket(const MarketOptions& options) : m_Options(options), m_StopThread(false)
+    {
+        m_MatchTradeThread = std::thread(&TransactionMarket::MatchThread, this);
+    }
+
+    ~TransactionMarket()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_StopThread = true;
+        }
+        m_CV.notify_all();
+        m_CapacityCV.notify_all();
+
+        if (m_MatchTradeThread.joinable())
+        {
+            m_MatchTradeThread.join();
+        }
+
+        m_Transactions.clear();
+        m_OrderIndex.clear();
+    }
+
+    // Mixing producers with the direct calls below on the same book is allowed,
+    // but only the producer commands are ordered by stamp.
+    Producer CreateProducer(size_t queueCapacity = 1024)
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_ProducerQueues.push_back(std::make_unique<SpscQueue<MarketCommand>>(queueCapacity));
+        return Producer(this, m_ProducerQueues.back().get());
+    }
+
+    ECreateResult CreateTransaction(ETransactType transactType, EOrderType orderType, int price, int quantity, std::string orderID)
+    {
+        PerfScope perf(EPerfOperation::CREATE);
+        ECreateResult result = ECreateResult::ACCEPTED;
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            if (m_Options.capacityPolicy == ECapacityPolicy::BACKPRESSURE && !HasCapacity(transactType))
+            {
+                ++m_CapacityWaiters;
+                m_CapacityCV.wait_for(lock, m_Options.backpressureTimeout, [this, transactType]
+                    {
+                        return m_StopThread || HasCapacity(transactType);
+                    });
+                --m_CapacityWaiters;
+            }
+
+            result = ApplyCreate(transactType, orderType, price, quantity, std::move(orderID));
+        }
+        if (result == ECreateResult::ACCEPTED)
+        {
+            NotifyMatcher();
+        }
+        return result;
+    }
+
+    // Cancelling never produces a trade, so it only tombstones the order and does not
+    // schedule a matching pass. The entry is physically removed by a later compaction.
+    void CancelTransaction(std::string orderID)
+    {
+        PerfScope perf(EPerfOperation::CANCEL);
+        bool compact = false;
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            compact = ApplyCancel(orderID);
+        }
+        if (compact)
+        {
+            NotifyMatcher();
+        }
+    }
+
+    void ModifyTransaction(std::string orderID, ETransactType transactType, int newPrice, int newQuantity)
+    {
+        PerfScope perf(EPerfOperation::MODIFY);
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            ApplyModify(orderID, transactType, newPrice, newQuantity);
+        }
+        NotifyMatcher();
+    }
+
+    void MatchThread()
+    {
+        PinCurrentThreadToCpu(m_Options.matchThreadCpu);
+
+        // Only run a matching pass when a command changed the book since the last pass,
+        // and never hold m_Mutex across MatchTransaction as it takes the lock itself.
+        while (WaitForWork())
+        {
+            while (HasQueuedCommands() && ApplyNextQueuedCommand())
+            {
+            }
+
+            if (HasPendingCommands())
+            {
+                MatchTransaction();
+            }
+
+            if (m_CompactRequested.load(std::memory_order_acquire))
+            {
+                std::lock_guard<std::mutex> lock(m_Mutex);
+                CompactTransactions();
+            }
+        }
+    }
+
+    // Blocks until every stamped producer command has been applied and matched. A queued cancel
+    // that changes nothing schedules no matching pass, so the wait polls rather than relying on
+    // the matching-done notification alone.
+    void WaitUntilIdle()
+    {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        while (!m_MatchingDoneCV.wait_for(lock, std::chrono::milliseconds(1), [this]
+            {
+                return !m_MatchingInProgress && !HasPendingCommands() && m_NextStamp.load(std::memory_order_acquire) == m_AppliedStamp;
+            }))
+        {
+        }
+    }
+
+    MarketMemoryUsage GetMemoryUsage()
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        MarketMemoryUsage usage;
+        usage.restingBuys = m_RestingCount[SideIndex(ETransactType::BUY)];
+        usage.restingSells = m_RestingCount[SideIndex(ETransactType::SELL)];
+        usage.tombstones = m_DeadCount;
+        usage.rejected = m_RejectedCount;
+        usage.orderBytes = m_OrderBytes;
+        usage.indexBytes = m_IndexBytes;
+        usage.reservedBytes = (m_Transactions.capacity() - m_Transactions.size()) * sizeof(std::shared_ptr<Transaction>) +
+            m_OrderIndex.bucket_count() * sizeof(void*);
+        for (const auto& queue : m_ProducerQueues)
+        {
+            usage.queueBytes += sizeof(SpscQueue<MarketCommand>) + queue->Capacity() * sizeof(MarketCommand);
+        }
+        return usage;
+    }
+
+    void PrintMemoryUsage()
+    {
+        MarketMemoryUsage usage = GetMemoryUsage();
+        std::cout << "MEMORY:" << std::endl;
+        std::cout << "resting " << usage.restingBuys + usage.restingSells << " buy " << usage.restingBuys << " sell " << usage.restingSells << std::endl;
+        std::cout << "tombstones " << usage.tombstones << std::endl;
+        std::cout << "rejected " << usage.rejected << std::endl;
+        std::cout << "orders " << usage.orderBytes << " bytes" << std::endl;
+        std::cout << "index " << usage.indexBytes << " bytes" << std::endl;
+        std::cout << "reserved " << usage.reservedBytes << " bytes" << std::endl;
+        std::cout << "queues " << usage.queueBytes << " bytes" << std::endl;
+        std::cout << "total " << usage.TotalBytes() << " bytes" << std::endl;
+    }
+
+private:
+    static size_t SideIndex(ETransactType transactType)
+    {
+        return transactType == ETransactType::BUY ? 0 : 1;
+    }
+
+    // Strings that fit the small-string buffer do not allocate.
+    static size_t HeapStringBytes(const std::string& str)
+    {
+        static const size_t inlineCapacity = std::string().capacity();
+        return str.capacity() > inlineCapacity ? str.capacity() + 1 : 0;
+    }
+
+    // make_shared places the control block (vtable pointer, use and weak counts) in front of the object.
+    static size_t OrderBytes(const Transaction& transaction)
+    {
+        return sizeof(std::shared_ptr<Transaction>) + sizeof(void*) + 2 * sizeof(int) + sizeof(Transaction) +
+            HeapStringBytes(transaction.GetOrderID());
+    }
+
+    // A hash node holds the pair, the next pointer and the cached hash.
+    static size_t IndexBytes(const std::string& orderID)
+    {
+        return sizeof(std::pair<const std::string, std::shared_ptr<Transaction>>) + sizeof(void*) + sizeof(size_t) +
+            HeapStringBytes(orderID);
+    }
+
+    // Caller must hold m_Mutex.
+    bool HasCapacity(ETransactType transactType) const
+    {
+        size_t total = m_RestingCount[0] + m_RestingCount[1];
+        if (m_Options.maxRestingOrders != 0 && total >= m_Options.maxRestingOrders)
+        {
+            return false;
+        }
+        if (m_Options.maxRestingOrdersPerSide != 0 && m_RestingCount[SideIndex(transactType)] >= m_Options.maxRestingOrdersPerSide)
+        {
+            return false;
+        }
+        return true;
+    }
+
+    // Caller must hold m_Mutex.
+    void ReleaseCapacity(ETransactType transactType)
+    {
+        --m_RestingCount[SideIndex(transactType)];
+        if (m_CapacityWaiters > 0)
+        {
+            m_CapacityCV.notify_all();
+        }
+    }
+
+    // Caller must hold m_Mutex.
+    void AddToBook(const std::shared_ptr<Transaction>& transaction)
+    {
+        m_Transactions.push_back(transaction);
+        m_OrderBytes += OrderBytes(*transaction);
+        ++m_RestingCount[SideIndex(transaction->GetTransactionType())];
+    }
+
+    // Removes every book entry shouldDrop selects, preserving time priority and keeping the byte
+    // count in step. The predicate is called exactly once per entry. Caller must hold m_Mutex.
+    template <typename Predicate>
+    void DropFromBook(Predicate shouldDrop)
+    {
+        auto kept = m_Transactions.begin();
+        for (auto it = m_Transactions.begin(); it != m_Transactions.end(); ++it)
+        {
+            if (shouldDrop(*it))
+            {
+                m_OrderBytes -= OrderBytes(**it);
+                continue;
+            }
+            if (kept != it)
+            {
+                *kept = std::move(*it);
+            }
+            ++kept;
+        }
+        m_Transactions.erase(kept, m_Transactions.end());
+    }
+
+    // Caller must hold m_Mutex.
+    void EraseFromIndex(std::unordered_map<std::string, std::shared_ptr<Transaction>>::iterator it)
     {
-        m_TransactionType = transactionType;
-        m_Price = price;
-        m_Quantity = quantity;
+        m_IndexBytes -= IndexBytes(it->first);
+        m_OrderIndex.erase(it);
     }
 
-    void UpdateQuantity(int tradedQuantity)
+    // Caller must hold m_Mutex. Never blocks, callers that want backpressure wait before calling.
+    ECreateResult ApplyCreate(ETransactType transactType, EOrderType orderType, int price, int quantity, std::string orderID)
     {
-        m_Quantity -= tradedQuantity;
-    }
+        // Check for duplicate orderID
+        if (m_OrderIndex.count(orderID) != 0)
+        {
+            // Duplicate found, do nothing
+            return ECreateResult::DUPLICATE;
+        }
 
-private:
-    ETransactType m_TransactionType;
-    EOrderType m_OrderType;
-    int m_Price;
-    int m_Quantity;
-    std::string m_OrderID;
-};
+        if (!HasCapacity(transactType))
+        {
+            ++m_RejectedCount;
+            return ECreateResult::REJECTED;
+        }
 
-class TransactionMarket
-{
-public:
-    TransactionMarket() : m_StopThread(false)
+        auto t = std::make_shared<Transaction>(transactType, orderType, price, quantity, orderID);
+        AddToBook(t);
+        m_IndexBytes += IndexBytes(orderID);
+        m_OrderIndex.emplace(std::move(orderID), t);
+        ++m_SubmittedSequence;
+        return ECreateResult::ACCEPTED;
+    }
+
+    // Returns true when the cancel asked the matcher to compact. Caller must hold m_Mutex.
+    bool ApplyCancel(const std::string& orderID)
     {
-        m_MatchTradeThread = std::thread(&TransactionMarket::MatchThread, this);
+        auto it = m_OrderIndex.find(orderID);
+        if (it == m_OrderIndex.end())
+        {
+            // If not found, do nothing (as per instruction)
+            return false;
+        }
+        bool compact = Tombstone(it->second);
+        EraseFromIndex(it);
+        return compact;
     }
 
-    ~TransactionMarket()
+    // Caller must hold m_Mutex.
+    void ApplyModify(const std::string& orderID, ETransactType transactType, int newPrice, int newQuantity)
     {
+        auto it = m_OrderIndex.find(orderID);
+        if (it != m_OrderIndex.end())
         {
-            std::lock_guard<std::mutex> lock(m_Mutex);
-            m_StopThread = true;
+            auto t = it->second;
+            if (t && t->CanBeModified())
+            {
+                // Moving to the other side must respect that side's cap
+                if (transactType != t->GetTransactionType() && m_Options.maxRestingOrdersPerSide != 0 &&
+                    m_RestingCount[SideIndex(transactType)] >= m_Options.maxRestingOrdersPerSide)
+                {
+                    ++m_RejectedCount;
+                    return;
+                }
+
+                // Create modified transaction using copy constructor first
+                auto modifiedT = std::make_shared<Transaction>(*t);
+                modifiedT->Modify(transactType, newPrice, newQuantity);
+
+                // Keep the delete and recreate pattern to reset priority,
+                // the old entry is tombstoned instead of erased from the middle of the book
+                Tombstone(t);
+                it->second = modifiedT;
+
+                // Add modified transaction at end of queue (loses priority)
+                AddToBook(modifiedT);
+                ++m_SubmittedSequence;
+            }
         }
-        m_CV.notify_all();
+    }
 
-        if (m_MatchTradeThread.joinable())
+    // Caller must hold m_Mutex.
+    void ApplyCommand(MarketCommand& command)
+    {
+        switch (command.action)
         {
-            m_MatchTradeThread.join();
+        case EUserAction::BUY:
+        case EUserAction::SELL:
+            ApplyCreate(command.transactType, command.orderType, command.price, command.quantity, std::move(command.orderID));
+            break;
+        case EUserAction::CANCEL:
+            ApplyCancel(command.orderID);
+            break;
+        case EUserAction::MODIFY:
+            ApplyModify(command.orderID, command.transactType, command.price, command.quantity);
+            break;
+        default:
+            break;
         }
+    }
 
-        m_Transactions.clear();
+    bool HasQueuedCommands() const
+    {
+        return m_NextStamp.load(std::memory_order_acquire) != m_AppliedStamp;
     }
 
-    void CreateTransaction(ETransactType transactType, EOrderType orderType, int price, int quantity, std::string orderID)
+    // Applies the producer command carrying the next stamp, then runs its matching pass.
+    // Producers queue in increasing stamp order, so the next stamp is at the front of
+    // exactly one queue. Returns false when that stamp was taken but not yet pushed.
+    bool ApplyNextQueuedCommand()
     {
+        bool changed = false;
         {
             std::lock_guard<std::mutex> lock(m_Mutex);
-            // Check for duplicate orderID
-            auto it = std::find_if(m_Transactions.begin(), m_Transactions.end(), [&orderID](const std::shared_ptr<Transaction>& transaction)
+            MarketCommand* command = nullptr;
+            size_t index = m_LastProducerIndex;
+            for (size_t i = 0; i < m_ProducerQueues.size() && command == nullptr; ++i)
+            {
+                // Start from the last queue served, bursts from one producer are common
+                index = (m_LastProducerIndex + i) % m_ProducerQueues.size();
+                MarketCommand* front = m_ProducerQueues[index]->Front();
+                if (front != nullptr && front->sequence == m_AppliedStamp)
                 {
-                    return transaction->GetOrderID() == orderID;
-                });
-            if (it != m_Transactions.end()) 
+                    command = front;
+                }
+            }
+
+            if (command == nullptr)
             {
-                // Duplicate found, do nothing
-                return;
+                return false;
             }
-            auto t = std::make_shared<Transaction>(transactType, orderType, price, quantity, orderID);
-            m_Transactions.push_back(t);
+
+            uint64_t before = m_SubmittedSequence.load(std::memory_order_relaxed);
+            ApplyCommand(*command);
+            m_ProducerQueues[index]->Pop();
+            m_LastProducerIndex = index;
+            ++m_AppliedStamp;
+            changed = m_SubmittedSequence.load(std::memory_order_relaxed) != before;
+        }
+
+        if (changed)
+        {
+            MatchTransaction();
         }
-        m_CV.notify_one();
+        return true;
     }
 
-    void CancelTransaction(std::string orderID)
+    // Spin strategies poll m_SubmittedSequence and do not need the futex wake.
+    void NotifyMatcher()
     {
+        if (m_Options.waitStrategy == EWaitStrategy::BLOCKING)
         {
-            std::lock_guard<std::mutex> lock(m_Mutex);
-            auto it = std::find_if(m_Transactions.begin(), m_Transactions.end(), [&orderID](const std::shared_ptr<Transaction>& transaction)
-                {
-                    return transaction->GetOrderID() == orderID;
-                });
+            m_CV.notify_one();
+        }
+    }
+
+    // Producers only take m_Mutex when the matcher is actually asleep. The fence pairs with the one
+    // in WaitForWork: either the matcher sees the queued command, or we see it going to sleep.
+    void NotifyIngest()
+    {
+        if (m_Options.waitStrategy != EWaitStrategy::BLOCKING)
+        {
+            return;
+        }
 
-            if (it != m_Transactions.end())
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_MatcherSleeping.load(std::memory_order_relaxed))
+        {
             {
-                m_Transactions.erase(it);
+                std::lock_guard<std::mutex> lock(m_Mutex);
             }
-            // If not found, do nothing (as per instruction)
+            m_CV.notify_one();
         }
-        m_CV.notify_one();
+    }
 
+    bool HasPendingCommands() const
+    {
+        return m_SubmittedSequence.load(std::memory_order_acquire) != m_MatchedSequence.load(std::memory_order_relaxed);
     }
 
-    void ModifyTransaction(std::string orderID, ETransactType transactType, int newPrice, int newQuantity)
+    bool HasWork() const
     {
+        return m_StopThread.load(std::memory_order_relaxed) || HasPendingCommands() || HasQueuedCommands() ||
+            m_CompactRequested.load(std::memory_order_relaxed);
+    }
+
+    // Returns false once the market is shutting down. Idle periods are used to compact tombstones.
+    bool WaitForWork()
+    {
+        switch (m_Options.waitStrategy)
         {
-            std::lock_guard<std::mutex> lock(m_Mutex);
-            auto it = std::find_if(m_Transactions.begin(), m_Transactions.end(), [&orderID](const std::shared_ptr<Transaction>& transaction)
+        case EWaitStrategy::BLOCKING:
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_MatcherSleeping.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            while (!m_CV.wait_for(lock, m_Options.idleCompactInterval, [this] { return HasWork(); }))
+            {
+                if (m_DeadCount > 0)
                 {
-                    return transaction->GetOrderID() == orderID;
-                });
-
-            if (it != m_Transactions.end())
+                    CompactTransactions();
+                }
+            }
+            m_MatcherSleeping.store(false, std::memory_order_relaxed);
+            break;
+        }
+        case EWaitStrategy::SPIN_THEN_YIELD:
+        {
+            int spins = 0;
+            while (!HasWork())
             {
-                auto t = *it;
-                if (t && t->CanBeModified())
+                if (spins < m_Options.spinIterations)
                 {
-                    // Create modified transaction using copy constructor first
-                    auto modifiedT = std::make_shared<Transaction>(*t);
-                    modifiedT->Modify(transactType, newPrice, newQuantity);
-
-                    // Keep the delete and recreate pattern to reset priority
-                    m_Transactions.erase(it);
-
-                    // Add modified transaction at end of queue (loses priority)
-                    m_Transactions.push_back(modifiedT);
+                    ++spins;
+                    CpuRelax();
+                }
+                else
+                {
+                    if (spins == m_Options.spinIterations)
+                    {
+                        // Spin budget exhausted, treat it as idle once before yielding
+                        ++spins;
+                        std::lock_guard<std::mutex> lock(m_Mutex);
+                        if (m_DeadCount > 0)
+                        {
+                            CompactTransactions();
+                        }
+                    }
+                    std::this_thread::yield();
                 }
             }
+            break;
+        }
+        case EWaitStrategy::BUSY_POLL:
+        {
+            // Never idle, compaction relies on the dead ratio threshold alone
+            while (!HasWork())
+            {
+                CpuRelax();
+            }
+            break;
+        }
         }
-        m_CV.notify_one();
+        return !m_StopThread;
     }
 
-    void MatchThread()
+    // Marks an order dead in O(1). Returns true when the book has crossed the compaction
+    // threshold and the matcher has been asked to compact. Caller must hold m_Mutex.
+    bool Tombstone(const std::shared_ptr<Transaction>& transaction)
     {
-        while (true)
+        transaction->MarkCancelled();
+        ++m_DeadCount;
+        ReleaseCapacity(transaction->GetTransactionType());
+
+        if (m_DeadCount >= m_Options.compactMinDead &&
+            static_cast<double>(m_DeadCount) >= m_Options.compactDeadRatio * static_cast<double>(m_Transactions.size()) &&
+            !m_CompactRequested.load(std::memory_order_relaxed))
         {
-            std::unique_lock<std::mutex> lock(m_Mutex);
-            m_CV.wait(lock, [this] { return m_StopThread || !m_Transactions.empty(); });
+            m_CompactRequested.store(true, std::memory_order_release);
+            return true;
+        }
+        return false;
+    }
 
-            if (m_StopThread)
+    // Single pass over the book dropping tombstones, preserving time priority. Caller must hold m_Mutex.
+    void CompactTransactions()
+    {
+        PerfScope perf(EPerfOperation::COMPACT);
+        DropFromBook([](const std::shared_ptr<Transaction>& transaction)
             {
-                break;
-            }
-
-            MatchTransaction();
-        }
+                return transaction->IsCancelled();
+            });
+        m_DeadCount = 0;
+        m_CompactRequested.store(false, std::memory_order_relaxed);
     }
 
-private:
-    void SplitOrders(const std::vector<std::shared_ptr<Transaction>>& all,
-                     std::vector<std::shared_ptr<Transaction>>& buys,
-                     std::vector<std::shared_ptr<Transaction>>& sells)
+    // An order as one matching pass sees it. The quantity is copied under m_Mutex, so matching
+    // never reads or writes a live order's quantity outside the lock.
+    struct OrderSnapshot
+    {
+        std::shared_ptr<Transaction> order;
+        int quantity = 0;
+        bool done = false; // Filled, or an IOC that traded, in this pass
+    };
+
+    // A trade found on the snapshot, applied to the orders only when the pass commits.
+    struct Fill
+    {
+        std::shared_ptr<Transaction> buy;
+        std::shared_ptr<Transaction> sell;
+        int price = 0;
+        int quantity = 0;
+    };
+
+    void SplitOrders(const std::vector<OrderSnapshot>& all,
+                     std::vector<OrderSnapshot>& buys,
+                     std::vector<OrderSnapshot>& sells)
     {
         for (const auto& t : all)
         {
-            if (t->GetTransactionType() == ETransactType::BUY)
+            if (t.order->IsCancelled())
+            {
+                continue;
+            }
+
+            if (t.order->GetTransactionType() == ETransactType::BUY)
             {
                 buys.push_back(t);
             }
-            else if (t->GetTransactionType() == ETransactType::SELL)
+            else if (t.order->GetTransactionType() == ETransactType::SELL)
             {
                 sells.push_back(t);
             }
         }
     }
 
-    void SortOrders(std::vector<std::shared_ptr<Transaction>>& buys,
-                   std::vector<std::shared_ptr<Transaction>>& sells)
+    void SortOrders(std::vector<OrderSnapshot>& buys,
+                   std::vector<OrderSnapshot>& sells)
     {
-        std::sort(buys.begin(), buys.end(), [](const std::shared_ptr<Transaction>& a, const std::shared_ptr<Transaction>& b)
+        std::sort(buys.begin(), buys.end(), [](const OrderSnapshot& a, const OrderSnapshot& b)
         {
-            return a->GetPrice() > b->GetPrice();
+            return a.order->GetPrice() > b.order->GetPrice();
         });
-        std::sort(sells.begin(), sells.end(), [](const std::shared_ptr<Transaction>& a, const std::shared_ptr<Transaction>& b)
+        std::sort(sells.begin(), sells.end(), [](const OrderSnapshot& a, const OrderSnapshot& b)
         {
-            return a->GetPrice() < b->GetPrice();
+            return a.order->GetPrice() < b.order->GetPrice();
         });
     }
 
-    std::set<std::shared_ptr<Transaction>> MatchOrders(
-        std::vector<std::shared_ptr<Transaction>>& buys,
-        std::vector<std::shared_ptr<Transaction>>& sells)
+    // Runs on the snapshot without the lock and only records what would trade.
+    std::vector<Fill> MatchOrders(
+        std::vector<OrderSnapshot>& buys,
+        std::vector<OrderSnapshot>& sells)
     {
-        std::set<std::shared_ptr<Transaction>> toRemove;
-        for (const auto& buy : buys)
+        std::vector<Fill> fills;
+        for (auto& buy : buys)
         {
-            if (toRemove.count(buy)) continue;
+            if (buy.done) continue;
 
-            for (const auto& sell : sells)
+            for (auto& sell : sells)
             {
-                if (toRemove.count(sell)) continue;
+                if (sell.done) continue;
 
-                if (buy->GetPrice() >= sell->GetPrice())
+                if (buy.order->GetPrice() >= sell.order->GetPrice())
                 {
-                    int tradeQty = std::min(buy->GetQuantity(), sell->GetQuantity());
-                    int tradePrice = sell->GetPrice();
-                    std::cout << "TRADE" << " " << buy->GetOrderID() << " " << tradePrice << " " << tradeQty << " " << sell->GetOrderID() << " " << tradePrice << " " << tradeQty << std::endl;
+                    int tradeQty = std::min(buy.quantity, sell.quantity);
+                    fills.push_back(Fill{ buy.order, sell.order, sell.order->GetPrice(), tradeQty });
 
-                    buy->UpdateQuantity(tradeQty);
-                    sell->UpdateQuantity(tradeQty);
+                    buy.quantity -= tradeQty;
+                    sell.quantity -= tradeQty;
+                    buy.done = buy.quantity == 0 || buy.order->GetOrderType() == EOrderType::IOC;
+                    sell.done = sell.quantity == 0 || sell.order->GetOrderType() == EOrderType::IOC;
 
-                    if (buy->GetQuantity() == 0)
+                    if (buy.done || sell.done)
                     {
-                        toRemove.insert(buy);
+                        break;
                     }
+                }
+            }
+        }
+        return fills;
+    }
 
-                    if (sell->GetQuantity() == 0)
-                    {
-                        toRemove.insert(sell);
-                    }
+    // Applies a pass's fills and prints its trades. If a cancel or modify tombstoned any order
+    // the pass traded since its snapshot, nothing is applied and false asks the caller to match
+    // again on the current book. Caller must hold m_Mutex.
+    bool CommitFills(const std::vector<Fill>& fills)
+    {
+        for (const Fill& fill : fills)
+        {
+            if (fill.buy->IsCancelled() || fill.sell->IsCancelled())
+            {
+                return false;
+            }
+        }
 
-                    if (buy->GetOrderType() == EOrderType::IOC)
-                    {
-                        toRemove.insert(buy);
-                    }
+        std::set<std::shared_ptr<Transaction>> toRemove;
+        for (const Fill& fill : fills)
+        {
+            std::cout << "TRADE" << " " << fill.buy->GetOrderID() << " " << fill.price << " " << fill.quantity << " " << fill.sell->GetOrderID() << " " << fill.price << " " << fill.quantity << std::endl;
 
-                    if (sell->GetOrderType() == EOrderType::IOC)
-                    {
-                        toRemove.insert(sell);
-                    }
+            fill.buy->UpdateQuantity(fill.quantity);
+            fill.sell->UpdateQuantity(fill.quantity);
 
-                    if (toRemove.count(buy) || toRemove.count(sell))
-                    {
-                        break;
-                    }
-                }
+            if (fill.buy->GetQuantity() == 0 || fill.buy->GetOrderType() == EOrderType::IOC)
+            {
+                toRemove.insert(fill.buy);
+            }
+
+            if (fill.sell->GetQuantity() == 0 || fill.sell->GetOrderType() == EOrderType::IOC)
+            {
+                toRemove.insert(fill.sell);
             }
         }
-        return toRemove;
+        RemoveMatchedOrders(toRemove);
+        return true;
     }
 
+    // The removal pass walks the whole book anyway, so it also drops tombstones.
+    // Caller must hold m_Mutex; CommitFills never passes a tombstoned order.
     void RemoveMatchedOrders(const std::set<std::shared_ptr<Transaction>>& toRemove)
     {
-        auto it = m_Transactions.begin();
-        while (it != m_Transactions.end())
+        if (toRemove.empty())
         {
-            if (toRemove.count(*it))
-            {
-                it = m_Transactions.erase(it);
-            }
-            else
+            return;
+        }
+
+        for (const auto& transaction : toRemove)
+        {
+            ReleaseCapacity(transaction->GetTransactionType());
+            auto it = m_OrderIndex.find(transaction->GetOrderID());
+            if (it != m_OrderIndex.end() && it->second == transaction)
             {
-                ++it;
+                EraseFromIndex(it);
             }
         }
+
+        DropFromBook([&toRemove](const std::shared_ptr<Transaction>& transaction)
+            {
+                return transaction->IsCancelled() || toRemove.count(transaction) != 0;
+            });
+        m_DeadCount = 0;
+        m_CompactRequested.store(false, std::memory_order_relaxed);
     }
 
 public:
     void MatchTransaction()
     {
-        std::vector<std::shared_ptr<Transaction>> transactionsCopy;
+        PerfScope perf(EPerfOperation::MATCH);
+        for (;;)
         {
-            std::lock_guard<std::mutex> lock(m_Mutex);
-            m_MatchingInProgress = true;
-            transactionsCopy = m_Transactions;
-        }
+            std::vector<OrderSnapshot> book;
+            uint64_t sequence = 0;
+            {
+                std::lock_guard<std::mutex> lock(m_Mutex);
+                m_MatchingInProgress = true;
+                book.reserve(m_Transactions.size());
+                for (const auto& transaction : m_Transactions)
+                {
+                    book.push_back(OrderSnapshot{ transaction, transaction->GetQuantity() });
+                }
+                sequence = m_SubmittedSequence.load(std::memory_order_relaxed);
+            }
 
-        std::vector<std::shared_ptr<Transaction>> buys, sells;
-        SplitOrders(transactionsCopy, buys, sells);
-        SortOrders(buys, sells);
-        std::set<std::shared_ptr<Transaction>> toRemove = MatchOrders(buys, sells);
+            std::vector<OrderSnapshot> buys, sells;
+            SplitOrders(book, buys, sells);
+            SortOrders(buys, sells);
+            std::vector<Fill> fills;
+            {
+                PerfScope matchPerf(EPerfOperation::MATCH_ORDERS);
+                fills = MatchOrders(buys, sells);
+            }
 
-        {
             std::lock_guard<std::mutex> lock(m_Mutex);
-            RemoveMatchedOrders(toRemove);
+            if (!CommitFills(fills))
+            {
+                continue;
+            }
+            m_MatchedSequence.store(sequence, std::memory_order_release);
             m_MatchingInProgress = false;
             m_MatchingDoneCV.notify_all();
+            return;
         }
     }
 
     void PrintTransaction()
     {
+        PerfScope perf(EPerfOperation::PRINT);
         std::map<int, int, std::greater<int>> sellBook;
         std::map<int, int, std::greater<int>> buyBook;
         {
             std::unique_lock<std::mutex> lock(m_Mutex);
 
             // FIX: Wait for matching to complete before printing to avoid inconsistent state
-            m_MatchingDoneCV.wait(lock, [this] { return !m_MatchingInProgress; });
+            // Also wait until every submitted command has been through a matching pass.
+            m_MatchingDoneCV.wait(lock, [this] { return !m_MatchingInProgress && !HasPendingCommands(); });
 
             for (const auto& element : m_Transactions)
             {
+                if (element->IsCancelled())
+                {
+                    continue;
+                }
+
                 if (element->GetTransactionType() == ETransactType::SELL)
                 {
                     sellBook[element->GetPrice()] += element->GetQuantity();
@@ -369,14 +1409,39 @@ public:
     }
 
 private:
+    MarketOptions m_Options;
     std::mutex m_Mutex;
     std::condition_variable m_CV;
     std::thread m_MatchTradeThread;
     std::atomic<bool> m_StopThread{ false }; // FIX: Use atomic for thread-safe access
 
-    std::vector<std::shared_ptr<Transaction>> m_Transactions;
+    std::vector<std::shared_ptr<Transaction>> m_Transactions; // Time priority order, may hold tombstones
+    std::unordered_map<std::string, std::shared_ptr<Transaction>> m_OrderIndex; // Live orders only
+    size_t m_DeadCount = 0;
+
+    // Resting order caps and memory accounting, all guarded by m_Mutex.
+    size_t m_RestingCount[2] = { 0, 0 }; // Live orders per side, indexed by SideIndex
+    size_t m_RejectedCount = 0;
+    size_t m_OrderBytes = 0;
+    size_t m_IndexBytes = 0;
+    int m_CapacityWaiters = 0;
+    std::condition_variable m_CapacityCV;
+    std::atomic<bool> m_CompactRequested{ false };
     std::atomic<bool> m_MatchingInProgress{ false };
     std::condition_variable m_MatchingDoneCV;
+
+    // Bumped under m_Mutex by every command that changes the book. The matcher publishes
+    // the sequence it last matched, so a differing value means there is work to do.
+    std::atomic<uint64_t> m_SubmittedSequence{ 0 };
+    std::atomic<uint64_t> m_MatchedSequence{ 0 };
+
+    // Multi-producer ingestion. m_NextStamp is the only state producers share. The queue list
+    // is guarded by m_Mutex, m_AppliedStamp and m_LastProducerIndex are owned by the matcher.
+    std::vector<std::unique_ptr<SpscQueue<MarketCommand>>> m_ProducerQueues;
+    alignas(64) std::atomic<uint64_t> m_NextStamp{ 0 };
+    uint64_t m_AppliedStamp = 0;
+    size_t m_LastProducerIndex = 0;
+    std::atomic<bool> m_MatcherSleeping{ false };
 };
 
 // Helper functions
@@ -405,10 +1470,241 @@ std::optional<ETransactType> ParseAsTransactionType(const std::string& str)
     return std::nullopt;
 }
 
-int main()
+std::optional<EWaitStrategy> ParseAsWaitStrategy(const std::string& str)
+{
+    if (str == "blocking") return EWaitStrategy::BLOCKING;
+    if (str == "spin") return EWaitStrategy::SPIN_THEN_YIELD;
+    if (str == "poll") return EWaitStrategy::BUSY_POLL;
+    return std::nullopt;
+}
+
+// Replays a seeded random command mix through the direct API and reports per-operation
+// wall time and hardware counters. Trade and book output is discarded while it runs.
+void RunBenchmark(const MarketOptions& options, int commandCount)
+{
+    struct NullBuffer : std::streambuf
+    {
+        int overflow(int c) override { return c; }
+    } nullBuffer;
+    std::streambuf* coutBuffer = std::cout.rdbuf(&nullBuffer);
+
+    PerfRecorder& recorder = PerfRecorder::Get();
+    recorder.Reset();
+    recorder.SetEnabled(true);
+
+    std::mt19937 random(12345);
+    std::uniform_int_distribution<int> percent(0, 99);
+    std::uniform_int_distribution<int> price(950, 1050);
+    std::uniform_int_distribution<int> quantity(1, 100);
+
+    auto start = std::chrono::steady_clock::now();
+    {
+        TransactionMarket market(options);
+        int created = 0;
+        for (int i = 0; i < commandCount; ++i)
+        {
+            int roll = percent(random);
+            if (roll < 60 || created == 0)
+            {
+                ETransactType side = (roll % 2 == 0) ? ETransactType::BUY : ETransactType::SELL;
+                market.CreateTransaction(side, EOrderType::GFD, price(random), quantity(random), "order" + std::to_string(created++));
+            }
+            else if (roll < 90)
+            {
+                market.CancelTransaction("order" + std::to_string(random() % created));
+            }
+            else if (roll < 99)
+            {
+                ETransactType side = (roll % 2 == 0) ? ETransactType::BUY : ETransactType::SELL;
+                market.ModifyTransaction("order" + std::to_string(random() % created), side, price(random), quantity(random));
+            }
+            else
+            {
+                market.PrintTransaction();
+            }
+        }
+        market.PrintTransaction();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    recorder.SetEnabled(false);
+    std::cout.rdbuf(coutBuffer);
+
+    std::cout << "BENCHMARK: " << commandCount << " commands in "
+        << std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count() << " ms" << std::endl;
+    recorder.Report(std::cout);
+}
+
+// Feeds one seeded command script through producerCount producers and returns every trade and
+// the final book as text. Producers take turns by script position, so the stamps, and with them
+// the matcher's input, are the same on every run even though each producer has its own thread.
+std::string ReplayThroughProducers(const MarketOptions& options, int producerCount, int commandCount)
+{
+    std::mt19937 random(2024);
+    std::uniform_int_distribution<int> percent(0, 99);
+    std::uniform_int_distribution<int> price(95, 105);
+    std::uniform_int_distribution<int> quantity(1, 50);
+
+    std::vector<MarketCommand> script;
+    int created = 0;
+    for (int i = 0; i < commandCount; ++i)
+    {
+        MarketCommand command;
+        int roll = percent(random);
+        command.transactType = (roll % 2 == 0) ? ETransactType::BUY : ETransactType::SELL;
+        command.price = price(random);
+        command.quantity = quantity(random);
+        if (roll < 65 || created == 0)
+        {
+            command.action = command.transactType == ETransactType::BUY ? EUserAction::BUY : EUserAction::SELL;
+            command.orderType = (roll % 5 == 0) ? EOrderType::IOC : EOrderType::GFD;
+            command.orderID = "order" + std::to_string(created++);
+        }
+        else
+        {
+            command.action = roll < 85 ? EUserAction::CANCEL : EUserAction::MODIFY;
+            command.orderID = "order" + std::to_string(random() % created);
+        }
+        script.push_back(command);
+    }
+
+    std::ostringstream trades;
+    std::streambuf* coutBuffer = std::cout.rdbuf(trades.rdbuf());
+    {
+        TransactionMarket market(options);
+        std::vector<TransactionMarket::Producer> producers;
+        for (int p = 0; p < producerCount; ++p)
+        {
+            producers.push_back(market.CreateProducer());
+        }
+
+        std::atomic<int> turn{ 0 };
+        std::vector<std::thread> threads;
+        for (int p = 0; p < producerCount; ++p)
+        {
+            threads.emplace_back([&, p]
+                {
+                    for (int i = p; i < commandCount; i += producerCount)
+                    {
+                        while (turn.load(std::memory_order_acquire) != i)
+                        {
+                            std::this_thread::yield();
+                        }
+
+                        const MarketCommand& command = script[i];
+                        switch (command.action)
+                        {
+                        case EUserAction::BUY:
+                        case EUserAction::SELL:
+                            producers[p].CreateTransaction(command.transactType, command.orderType, command.price, command.quantity, command.orderID);
+                            break;
+                        case EUserAction::CANCEL:
+                            producers[p].CancelTransaction(command.orderID);
+                            break;
+                        default:
+                            producers[p].ModifyTransaction(command.orderID, command.transactType, command.price, command.quantity);
+                            break;
+                        }
+                        turn.store(i + 1, std::memory_order_release);
+                    }
+                });
+        }
+
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+        market.WaitUntilIdle();
+        market.PrintTransaction();
+    }
+    std::cout.rdbuf(coutBuffer);
+    return trades.str();
+}
+
+// Replays the same stamped script twice through producerCount producers and once through a
+// single producer; all three must produce the same trades in the same order.
+bool RunProducerReplay(const MarketOptions& options, int producerCount, int commandCount = 2000)
+{
+    std::string first = ReplayThroughProducers(options, producerCount, commandCount);
+    std::string second = ReplayThroughProducers(options, producerCount, commandCount);
+    std::string single = ReplayThroughProducers(options, 1, commandCount);
+
+    bool identical = first == second && first == single;
+    long long lines = std::count(first.begin(), first.end(), '\n');
+    std::cout << "REPLAY: " << producerCount << " producers, " << commandCount << " commands, "
+        << lines << " output lines: " << (identical ? "identical" : "MISMATCH") << std::endl;
+    return identical;
+}
+
+std::optional<ECapacityPolicy> ParseAsCapacityPolicy(const std::string& str)
+{
+    if (str == "reject") return ECapacityPolicy::REJECT;
+    if (str == "wait") return ECapacityPolicy::BACKPRESSURE;
+    return std::nullopt;
+}
+
+// Usage: --match-cpu <n> --io-cpu <n> --wait <blocking|spin|poll> --spin <iterations>
+//        --max-orders <n> --max-side-orders <n> --on-full <reject|wait>
+MarketOptions ParseMarketOptions(int argc, char* argv[])
+{
+    MarketOptions options;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        std::string key = argv[i];
+        std::string value = argv[i + 1];
+        if (key == "--match-cpu")
+        {
+            options.matchThreadCpu = ParseAsInt(value).value_or(-1);
+        }
+        else if (key == "--io-cpu")
+        {
+            options.ioThreadCpu = ParseAsInt(value).value_or(-1);
+        }
+        else if (key == "--wait")
+        {
+            options.waitStrategy = ParseAsWaitStrategy(value).value_or(EWaitStrategy::BLOCKING);
+        }
+        else if (key == "--spin")
+        {
+            options.spinIterations = ParseAsInt(value).value_or(options.spinIterations);
+        }
+        else if (key == "--max-orders")
+        {
+            options.maxRestingOrders = static_cast<size_t>(std::max(0, ParseAsInt(value).value_or(0)));
+        }
+        else if (key == "--max-side-orders")
+        {
+            options.maxRestingOrdersPerSide = static_cast<size_t>(std::max(0, ParseAsInt(value).value_or(0)));
+        }
+        else if (key == "--on-full")
+        {
+            options.capacityPolicy = ParseAsCapacityPolicy(value).value_or(ECapacityPolicy::REJECT);
+        }
+    }
+    return options;
+}
+
+int main(int argc, char* argv[])
 {
     bool exit = false;
-    TransactionMarket* market = new TransactionMarket();
+    MarketOptions options = ParseMarketOptions(argc, argv);
+    PinCurrentThreadToCpu(options.ioThreadCpu);
+
+    // --bench <commands> runs the synthetic benchmark instead of reading commands from stdin,
+    // --replay <producers> checks that multi-producer input replays to identical trades
+    for (int i = 1; i + 1 < argc; ++i)
+    {
+        if (std::string(argv[i]) == "--bench")
+        {
+            RunBenchmark(options, ParseAsInt(argv[i + 1]).value_or(100000));
+            return 0;
+        }
+        if (std::string(argv[i]) == "--replay")
+        {
+            return RunProducerReplay(options, std::max(1, ParseAsInt(argv[i + 1]).value_or(4))) ? 0 : 1;
+        }
+    }
+    TransactionMarket* market = new TransactionMarket(options);
 
     while (!exit)
     {
@@ -433,7 +1729,10 @@ int main()
             std::optional<int> quantity = ParseAsInt(param4);
             if (action.has_value() && type.has_value() && price.has_value() && quantity.has_value())
             {
-                market->CreateTransaction(action.value(), type.value(), price.value(), quantity.value(), param5);
+                if (market->CreateTransaction(action.value(), type.value(), price.value(), quantity.value(), param5) == ECreateResult::REJECTED)
+                {
+                    std::cerr << "REJECTED " << param5 << std::endl;
+                }
             }
         }
         else if (param1 == "CANCEL")
@@ -454,6 +1753,10 @@ int main()
         {
             market->PrintTransaction();
         }
+        else if (param1 == "MEMORY")
+        {
+            market->PrintMemoryUsage();
+        }
     }
 
     return 0;
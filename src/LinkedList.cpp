@@ -1,5 +1,7 @@
 #include <utility>
 #include <cstdlib>
+#include <cstddef>
+#include <cstdint>
 #include <ctime>
 #include <algorithm>
 #include <optional>
@@ -10,36 +12,58 @@
 #include <variant>
 #include <unordered_set>
 #include <queue>
+#include <new>
+#include <string>
+#include <chrono>
+#include <type_traits>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <iterator>
+#include <atomic>
+#include <cassert>
+
+template <typename T>
+class ListNodePool;
 
 template <typename T>
 class ListNode
 {
 public:
 	ListNode* pNext = nullptr;
-	T* pValue = nullptr;
+	T value;
 
-	ListNode() : pValue(new T()), pNext(nullptr) {};
-	ListNode(const T& value) : pValue(new T(value)), pNext(nullptr) {};
-	ListNode(T&& value) : pValue(new T(std::move(value))), pNext(nullptr) {};
-	ListNode(const T& value, ListNode* next) : pValue(new T(value)), pNext(next) {};
-	~ListNode()
+	ListNode() : pNext(nullptr), value() {};
+	ListNode(const T& value) : pNext(nullptr), value(value) {};
+	ListNode(T&& value) : pNext(nullptr), value(std::move(value)) {};
+	ListNode(const T& value, ListNode* next) : pNext(next), value(value) {};
+
+	// Heap nodes come from the global heap, or from the calling thread's pool while a
+	// ListNodePool::Scope is active.
+	static void* operator new(std::size_t size)
 	{
-		delete pValue;
-		pValue = nullptr;
-		pNext = nullptr;
+		ListNodePool<T>* pool = ListNodePool<T>::Current();
+		return pool != nullptr ? pool->Allocate(size) : ::operator new(size);
 	}
 
-	void Print() const
+	// A pooled node goes back to the pool owning its chunk, whichever thread frees it and whether
+	// or not a scope is still active; anything else goes back to the global heap.
+	static void operator delete(void* node, std::size_t size)
 	{
-		if (pValue)
+		ListNodePool<T>* pool = ListNodePool<T>::Owner(node);
+		if (pool != nullptr)
 		{
-			// Use a helper function to print the value safely
-			PrintValue(*pValue);
-		}
-		else
-		{
-			std::cout << "null";
+			pool->Deallocate(node);
+			return;
 		}
+		::operator delete(node, size);
+	}
+
+	void Print() const
+	{
+		// Use a helper function to print the value safely
+		PrintValue(value);
 	}
 
 private:
@@ -58,810 +82,3614 @@ private:
 	}
 };
 
-namespace ListNodeHelper
+// Maps every live ListNodePool chunk to its pool, so `delete node` finds the owner of a pooled node
+// from any thread, and recognizes a global heap node without reading its memory. Chunks are aligned
+// to their own size, so the chunk index is the address shifted right. Two levels cover a 48 bit
+// address space; leaves are allocated on first use and, like the roots, never freed.
+class ListNodeChunkMap
 {
-	template <typename T>
-	void Print(ListNode<T>* head)
+public:
+	static constexpr int CHUNK_BITS = 16;
+
+	static void* Find(const void* address)
 	{
-		const ListNode<T>* curent = head;
-		while (curent != nullptr)
+		std::uintptr_t chunk = reinterpret_cast<std::uintptr_t>(address) >> CHUNK_BITS;
+		if ((chunk >> (LEAF_BITS + ROOT_BITS)) != 0)
 		{
-			curent->Print();
-			std::cout << " -> ";
-			curent = curent->pNext;
+			return nullptr;
 		}
-		std::cout << "null" << std::endl;
+		Leaf* leaf = s_Roots[chunk >> LEAF_BITS].load(std::memory_order_acquire);
+		return leaf != nullptr ? leaf->owners[chunk & LEAF_MASK].load(std::memory_order_acquire) : nullptr;
 	}
 
-	template <typename T>
-	void Print(const std::string& label, ListNode<T>* head)
+	// Registers a chunk with owner, or unregisters it with nullptr.
+	static void Set(const void* chunkAddress, void* owner)
 	{
-		std::cout << label << ": ";
-		Print(head);
+		std::uintptr_t chunk = reinterpret_cast<std::uintptr_t>(chunkAddress) >> CHUNK_BITS;
+		assert((chunk >> (LEAF_BITS + ROOT_BITS)) == 0 && "Address beyond 48 bits");
+		std::atomic<Leaf*>& root = s_Roots[chunk >> LEAF_BITS];
+		Leaf* leaf = root.load(std::memory_order_acquire);
+		if (leaf == nullptr)
+		{
+			Leaf* created = new Leaf();
+			if (root.compare_exchange_strong(leaf, created, std::memory_order_acq_rel, std::memory_order_acquire))
+			{
+				leaf = created;
+			}
+			else
+			{
+				delete created;
+			}
+		}
+		leaf->owners[chunk & LEAF_MASK].store(owner, std::memory_order_release);
 	}
 
-	template <typename T>
-	int Size(ListNode<T>* head)
+private:
+	static constexpr int LEAF_BITS = 16;
+	static constexpr int ROOT_BITS = 48 - CHUNK_BITS - LEAF_BITS;
+	static constexpr std::uintptr_t LEAF_MASK = (std::uintptr_t(1) << LEAF_BITS) - 1;
+
+	struct Leaf
 	{
-		int size = 0;
-		ListNode<T>* current = head;
-		while (current != nullptr)
-		{
-			++size;
-			current = current->pNext;
-		}
-		return size;
+		std::atomic<void*> owners[std::size_t(1) << LEAF_BITS]{};
+	};
+
+	// Zero initialized static storage, no constructor runs before first use.
+	inline static std::atomic<Leaf*> s_Roots[std::size_t(1) << ROOT_BITS];
+};
+
+// Chunked free list for ListNode<T>, opt-in through Scope: while a scope is active, `new ListNode<T>`
+// on that thread draws from the pool, otherwise nodes come from the global heap.
+// `delete` finds a pooled node's pool through ListNodeChunkMap. The thread holding the pool's scope
+// recycles it directly; any other thread, or any delete after the scope ended, pushes it on a
+// lock-free remote list that the pool collects when its free list runs dry.
+// Allocation is not thread safe: hold a pool's scope on one thread at a time. Nodes must not
+// outlive their pool, Release and the destructor drop every node at once.
+template <typename T>
+class ListNodePool
+{
+public:
+	static constexpr std::size_t CHUNK_SIZE = 64 * 1024;
+
+	ListNodePool() = default;
+	ListNodePool(const ListNodePool&) = delete;
+	ListNodePool& operator=(const ListNodePool&) = delete;
+
+	~ListNodePool()
+	{
+		FreeChunks();
 	}
 
-	struct LoopDetector
+	void* Allocate(std::size_t size)
 	{
-		// LeetCode 141 - Detect if a loop exists in the linked list
-		template <typename T>
-		static ListNode<T>* DetectMeetingPoint(ListNode<T>* head)
+		if (size != sizeof(ListNode<T>))
 		{
-			ListNode<T>* slow = head;
-			ListNode<T>* fast = head;
-			while (fast && fast->pNext)
-			{
-				slow = slow->pNext;
-				fast = fast->pNext->pNext;
-				if (slow == fast)
-				{
-					return slow;
-				}
-			}
-			return nullptr;
+			// A type deriving from ListNode does not fit the slots, hand it to the global heap.
+			return ::operator new(size);
 		}
 
-		// LeetCode 142 - Find the entry point of the loop
-		template <typename T>
-		static ListNode<T>* FindLoopEntry(ListNode<T>* head, ListNode<T>* meeting)
+		if (m_pFree == nullptr)
 		{
-			if (!meeting)
-			{
-				return nullptr;
-			}
-
-			ListNode<T>* slow = head;
-			ListNode<T>* fast = meeting;
-			while (slow != fast)
-			{
-				slow = slow->pNext;
-				fast = fast->pNext;
-			}
-			return slow;
+			CollectRemoteFrees();
 		}
-
-		template <typename T>
-		static ListNode<T>* FindLoopTail(ListNode<T>* entry)
+		if (m_pFree == nullptr)
 		{
-			if (!entry)
-			{
-				return nullptr;
-			}
-
-			ListNode<T>* current = entry;
-			while (current->pNext != entry)
-			{
-				current = current->pNext;
-			}
-			return current;
+			AddChunk();
 		}
-	};
 
-	template <typename T>
-	void BreakLoop(ListNode<T>* head)
+		FreeSlot* slot = m_pFree;
+		m_pFree = slot->pNext;
+		++m_LiveCount;
+		return slot;
+	}
+
+	// The pool whose chunk holds node, null for nodes from the global heap. Never dereferences node.
+	static ListNodePool* Owner(const void* node)
 	{
-		auto meeting = LoopDetector::DetectMeetingPoint(head);
-		if (!meeting)
+		return static_cast<ListNodePool*>(ListNodeChunkMap::Find(node));
+	}
+
+	// Takes back a node this pool owns, from any thread.
+	void Deallocate(void* node)
+	{
+		FreeSlot* slot = static_cast<FreeSlot*>(node);
+		if (CurrentSlot() == this)
 		{
+			slot->pNext = m_pFree;
+			m_pFree = slot;
+			--m_LiveCount;
 			return;
 		}
 
-		auto entry = LoopDetector::FindLoopEntry(head, meeting);
-		auto tail = LoopDetector::FindLoopTail(entry);
-		if (tail)
+		FreeSlot* head = m_pRemoteFree.load(std::memory_order_relaxed);
+		do
 		{
-			tail->pNext = nullptr;
-		}
+			slot->pNext = head;
+		} while (!m_pRemoteFree.compare_exchange_weak(head, slot, std::memory_order_release, std::memory_order_relaxed));
 	}
 
-	template <typename T>
-	bool ContainsLoop(ListNode<T>* head)
+	// Drops every node handed out by this pool at once, without walking any list.
+	// Only valid when nodes need no destructor; outstanding node pointers become dangling.
+	void Release()
 	{
-		return LoopDetector::DetectMeetingPoint(head) != nullptr;
+		static_assert(std::is_trivially_destructible<ListNode<T>>::value, "Release skips destructors, use FreeList instead");
+		FreeChunks();
 	}
 
-	template <typename T>
-	std::optional<int> GetLoopEntryIndex(ListNode<T>* head)
+	// Collects remote frees first, so call it where the pool allocates.
+	std::size_t GetLiveCount()
 	{
-		auto meeting = LoopDetector::DetectMeetingPoint(head);
-		if (!meeting) return std::nullopt;
+		CollectRemoteFrees();
+		return m_LiveCount;
+	}
 
-		auto entry = LoopDetector::FindLoopEntry(head, meeting);
+	std::size_t GetChunkCount() const
+	{
+		return m_Chunks.size();
+	}
 
-		int index = 0;
-		for (auto cur = head; cur != entry; cur = cur->pNext)
+	// The pool `new ListNode<T>` draws from on this thread, null outside any Scope.
+	static ListNodePool* Current()
+	{
+		return CurrentSlot();
+	}
+
+	// Routes this thread's node allocations to `pool` until the scope ends.
+	class Scope
+	{
+	public:
+		explicit Scope(ListNodePool& pool) : m_pPrevious(CurrentSlot())
 		{
-			++index;
+			CurrentSlot() = &pool;
 		}
-		return index;
+
+		~Scope()
+		{
+			CurrentSlot() = m_pPrevious;
+		}
+
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+
+	private:
+		ListNodePool* m_pPrevious;
+	};
+
+private:
+	struct FreeSlot
+	{
+		FreeSlot* pNext;
+	};
+
+	static constexpr std::size_t SLOTS_PER_CHUNK = CHUNK_SIZE / sizeof(ListNode<T>);
+
+	static ListNodePool*& CurrentSlot()
+	{
+		thread_local ListNodePool* current = nullptr;
+		return current;
 	}
 
-	struct IntersectionDetector
+	void AddChunk()
 	{
-		// LeetCode 160 - Detect intersection of two linked lists
-		template <typename T>
-		static ListNode<T>* DetectIntersection(ListNode<T>* head1, ListNode<T>* head2)
-		{
-			if (!head1 || !head2)
-			{
-				return nullptr;
-			}
+		static_assert(SLOTS_PER_CHUNK >= 16, "ListNode<T> is too large to pool");
+		static_assert(alignof(ListNode<T>) <= CHUNK_SIZE, "ListNode<T> is over-aligned");
 
-			ListNode<T>* current1 = head1;
-			ListNode<T>* current2 = head2;
+		static_assert(CHUNK_SIZE == std::size_t(1) << ListNodeChunkMap::CHUNK_BITS, "Chunks must match the chunk map");
 
-			while (current1 != current2)
-			{
-				current1 = (current1 == nullptr) ? head2 : current1->pNext;
-				current2 = (current2 == nullptr) ? head1 : current2->pNext;
-			}
-			return current1;
+		void* memory = ::operator new(CHUNK_SIZE, std::align_val_t(CHUNK_SIZE));
+		m_Chunks.push_back(memory);
+		ListNodeChunkMap::Set(memory, this);
+
+		// Thread the new slots in address order so consecutive allocations are adjacent.
+		char* first = static_cast<char*>(memory);
+		for (std::size_t i = SLOTS_PER_CHUNK; i > 0; --i)
+		{
+			FreeSlot* slot = reinterpret_cast<FreeSlot*>(first + (i - 1) * sizeof(ListNode<T>));
+			slot->pNext = m_pFree;
+			m_pFree = slot;
 		}
-	};;
+	}
 
-	template <typename T>
-	void FreeList(ListNode<T>* head)
+	// Moves the nodes other threads freed onto the local free list.
+	void CollectRemoteFrees()
 	{
-		if (!head)
+		FreeSlot* slot = m_pRemoteFree.exchange(nullptr, std::memory_order_acquire);
+		while (slot != nullptr)
 		{
-			return;
+			FreeSlot* next = slot->pNext;
+			slot->pNext = m_pFree;
+			m_pFree = slot;
+			--m_LiveCount;
+			slot = next;
 		}
+	}
 
-		BreakLoop(head);
-
-		while (head != nullptr)
+	void FreeChunks()
+	{
+		for (void* chunk : m_Chunks)
 		{
-			ListNode<T>* next = head->pNext;
-			delete head;
-			head = next;
+			ListNodeChunkMap::Set(chunk, nullptr);
+			::operator delete(chunk, std::align_val_t(CHUNK_SIZE));
 		}
+		m_Chunks.clear();
+		m_pFree = nullptr;
+		m_pRemoteFree.store(nullptr, std::memory_order_relaxed);
+		m_LiveCount = 0;
 	}
 
-	// Leet Code 876
-	template <typename T>
-	ListNode<T>* GetMiddleNode(ListNode<T>* head)
+	std::vector<void*> m_Chunks;
+	FreeSlot* m_pFree = nullptr;
+	std::atomic<FreeSlot*> m_pRemoteFree{ nullptr };
+	std::size_t m_LiveCount = 0;
+};
+
+// Forward iterator over the values of a ListNode chain, so range-for and the standard
+// algorithms work on bare chains. ListNodeIterator<const T> walks a chain read-only.
+template <typename T>
+class ListNodeIterator
+{
+public:
+	using iterator_category = std::forward_iterator_tag;
+	using value_type = std::remove_const_t<T>;
+	using difference_type = std::ptrdiff_t;
+	using pointer = T*;
+	using reference = T&;
+	using Node = std::conditional_t<std::is_const<T>::value, const ListNode<value_type>, ListNode<value_type>>;
+
+	ListNodeIterator() = default;
+	explicit ListNodeIterator(Node* node) : m_pNode(node) {}
+
+	reference operator*() const { return m_pNode->value; }
+	pointer operator->() const { return &m_pNode->value; }
+
+	ListNodeIterator& operator++()
 	{
-		ListNode<T>* slow = head;
-		ListNode<T>* fast = head;
+		m_pNode = m_pNode->pNext;
+		return *this;
+	}
 
-		while (fast && fast->pNext)
-		{
-			slow = slow->pNext;
-			fast = fast->pNext->pNext;
-		}
-		return slow;
+	ListNodeIterator operator++(int)
+	{
+		ListNodeIterator copy = *this;
+		++*this;
+		return copy;
 	}
 
-	// Leet Code 82 - If a node is ever duplicated, remove them entirely
+	bool operator==(const ListNodeIterator& other) const { return m_pNode == other.m_pNode; }
+	bool operator!=(const ListNodeIterator& other) const { return m_pNode != other.m_pNode; }
+
+	Node* GetNode() const { return m_pNode; }
+
+private:
+	Node* m_pNode = nullptr;
+};
+
+// Lazy views over ListNode chains. Views hold their source by value and do no work until
+// iterated, so a pipeline such as
+//     ListNodeView::All(head) | ListNodeView::Filter(keep) | ListNodeView::Unique() | ListNodeView::Chunk(4)
+// visits every node once and never relinks or allocates nodes.
+namespace ListNodeView
+{
+	template <typename Iterator>
+	class Range
+	{
+	public:
+		Range(Iterator first, Iterator last) : m_Begin(first), m_End(last) {}
+
+		Iterator begin() const { return m_Begin; }
+		Iterator end() const { return m_End; }
+
+	private:
+		Iterator m_Begin;
+		Iterator m_End;
+	};
+
 	template <typename T>
-	ListNode<T>* RemoveDuplicates(ListNode<T>* head)
+	Range<ListNodeIterator<T>> All(ListNode<T>* head)
 	{
-		if (head != nullptr)
+		return Range<ListNodeIterator<T>>(ListNodeIterator<T>(head), ListNodeIterator<T>());
+	}
+
+	template <typename T>
+	Range<ListNodeIterator<const T>> All(const ListNode<T>* head)
+	{
+		return Range<ListNodeIterator<const T>>(ListNodeIterator<const T>(head), ListNodeIterator<const T>());
+	}
+
+	template <typename Base>
+	using BaseIterator = decltype(std::declval<const Base&>().begin());
+
+	template <typename Base>
+	using BaseValue = std::decay_t<decltype(*std::declval<BaseIterator<Base>>())>;
+
+	// Values for which predicate(value) holds.
+	template <typename Base, typename Predicate>
+	class FilterView
+	{
+	public:
+		class Iterator
 		{
-			ListNode<T>* previous = nullptr;
-			ListNode<T>* current = head;
-			ListNode<T>* node = nullptr;
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = BaseValue<Base>;
+			using difference_type = std::ptrdiff_t;
+			using reference = decltype(*std::declval<BaseIterator<Base>>());
+			using pointer = void;
+
+			Iterator() = default;
+			Iterator(BaseIterator<Base> current, BaseIterator<Base> last, const Predicate* predicate)
+				: m_Current(current), m_End(last), m_pPredicate(predicate)
+			{
+				SkipRejected();
+			}
 
-			while (current->pNext != nullptr)
+			reference operator*() const { return *m_Current; }
+
+			Iterator& operator++()
 			{
-				if (current->pValue != nullptr && current->pNext->pValue != nullptr && *current->pValue == *current->pNext->pValue)
-				{
-					// additionally mark current node to delete after deleting all trailing duplicates. 
-					node = current;
+				++m_Current;
+				SkipRejected();
+				return *this;
+			}
 
-					// deleting trailing duplicates
-					ListNode<T>* next = current->pNext;
-					current->pNext = (next != nullptr) ? next->pNext : nullptr;
-					delete next;
-					next = nullptr;
-				}
-				else
-				{
-					if (node != nullptr)
-					{
-						if (previous != nullptr)
-						{
-							previous->pNext = current->pNext;
-							delete node;
-							node = nullptr;
+			Iterator operator++(int)
+			{
+				Iterator copy = *this;
+				++*this;
+				return copy;
+			}
 
-							current = previous->pNext;
-						}
-						else // previous is nullptr, promoting new head.
-						{
-							head = current->pNext;
-							delete node;
-							node = nullptr;
+			bool operator==(const Iterator& other) const { return m_Current == other.m_Current; }
+			bool operator!=(const Iterator& other) const { return m_Current != other.m_Current; }
 
-							// old head removed, assign to new head.
-							current = head;
+		private:
+			void SkipRejected()
+			{
+				while (m_Current != m_End && !(*m_pPredicate)(*m_Current))
+				{
+					++m_Current;
+				}
+			}
+
+			BaseIterator<Base> m_Current;
+			BaseIterator<Base> m_End;
+			const Predicate* m_pPredicate = nullptr;
+		};
+
+		FilterView(Base base, Predicate predicate) : m_Base(std::move(base)), m_Predicate(std::move(predicate)) {}
+
+		Iterator begin() const { return Iterator(m_Base.begin(), m_Base.end(), &m_Predicate); }
+		Iterator end() const { return Iterator(m_Base.end(), m_Base.end(), &m_Predicate); }
+
+	private:
+		Base m_Base;
+		Predicate m_Predicate;
+	};
+
+	// function(value) for every value, computed on dereference.
+	template <typename Base, typename Function>
+	class TransformView
+	{
+	public:
+		class Iterator
+		{
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using reference = decltype(std::declval<const Function&>()(*std::declval<BaseIterator<Base>>()));
+			using value_type = std::decay_t<reference>;
+			using difference_type = std::ptrdiff_t;
+			using pointer = void;
+
+			Iterator() = default;
+			Iterator(BaseIterator<Base> current, const Function* function) : m_Current(current), m_pFunction(function) {}
+
+			reference operator*() const { return (*m_pFunction)(*m_Current); }
+
+			Iterator& operator++()
+			{
+				++m_Current;
+				return *this;
+			}
+
+			Iterator operator++(int)
+			{
+				Iterator copy = *this;
+				++*this;
+				return copy;
+			}
+
+			bool operator==(const Iterator& other) const { return m_Current == other.m_Current; }
+			bool operator!=(const Iterator& other) const { return m_Current != other.m_Current; }
+
+		private:
+			BaseIterator<Base> m_Current;
+			const Function* m_pFunction = nullptr;
+		};
+
+		TransformView(Base base, Function function) : m_Base(std::move(base)), m_Function(std::move(function)) {}
+
+		Iterator begin() const { return Iterator(m_Base.begin(), &m_Function); }
+		Iterator end() const { return Iterator(m_Base.end(), &m_Function); }
+
+	private:
+		Base m_Base;
+		Function m_Function;
+	};
+
+	// At most the first `count` values; stops pulling from the source once they are reached.
+	template <typename Base>
+	class TakeView
+	{
+	public:
+		class Iterator
+		{
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = BaseValue<Base>;
+			using difference_type = std::ptrdiff_t;
+			using reference = decltype(*std::declval<BaseIterator<Base>>());
+			using pointer = void;
+
+			Iterator() = default;
+			Iterator(BaseIterator<Base> current, BaseIterator<Base> last, int remaining)
+				: m_Current(current), m_End(last), m_Remaining(remaining) {}
+
+			reference operator*() const { return *m_Current; }
+
+			Iterator& operator++()
+			{
+				++m_Current;
+				--m_Remaining;
+				return *this;
+			}
+
+			Iterator operator++(int)
+			{
+				Iterator copy = *this;
+				++*this;
+				return copy;
+			}
+
+			bool operator==(const Iterator& other) const
+			{
+				if (IsDone() || other.IsDone())
+				{
+					return IsDone() && other.IsDone();
+				}
+				return m_Current == other.m_Current;
+			}
+
+			bool operator!=(const Iterator& other) const { return !(*this == other); }
+
+		private:
+			bool IsDone() const
+			{
+				return m_Remaining <= 0 || m_Current == m_End;
+			}
+
+			BaseIterator<Base> m_Current;
+			BaseIterator<Base> m_End;
+			int m_Remaining = 0;
+		};
+
+		TakeView(Base base, int count) : m_Base(std::move(base)), m_Count(count) {}
+
+		Iterator begin() const { return Iterator(m_Base.begin(), m_Base.end(), m_Count); }
+		Iterator end() const { return Iterator(m_Base.end(), m_Base.end(), 0); }
+
+	private:
+		Base m_Base;
+		int m_Count;
+	};
+
+	// Skips values equal to the one before them, like MakeUnique but without unlinking anything.
+	template <typename Base>
+	class UniqueView
+	{
+	public:
+		class Iterator
+		{
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = BaseValue<Base>;
+			using difference_type = std::ptrdiff_t;
+			using reference = decltype(*std::declval<BaseIterator<Base>>());
+			using pointer = void;
+
+			Iterator() = default;
+			Iterator(BaseIterator<Base> current, BaseIterator<Base> last) : m_Current(current), m_End(last) {}
+
+			reference operator*() const { return *m_Current; }
+
+			Iterator& operator++()
+			{
+				value_type last = *m_Current;
+				do
+				{
+					++m_Current;
+				} while (m_Current != m_End && *m_Current == last);
+				return *this;
+			}
+
+			Iterator operator++(int)
+			{
+				Iterator copy = *this;
+				++*this;
+				return copy;
+			}
+
+			bool operator==(const Iterator& other) const { return m_Current == other.m_Current; }
+			bool operator!=(const Iterator& other) const { return m_Current != other.m_Current; }
+
+		private:
+			BaseIterator<Base> m_Current;
+			BaseIterator<Base> m_End;
+		};
+
+		explicit UniqueView(Base base) : m_Base(std::move(base)) {}
+
+		Iterator begin() const { return Iterator(m_Base.begin(), m_Base.end()); }
+		Iterator end() const { return Iterator(m_Base.end(), m_Base.end()); }
+
+	private:
+		Base m_Base;
+	};
+
+	// Consecutive groups of `size` values, the last one possibly shorter. Each group is gathered
+	// into a buffer owned by the iterator while the source is walked, so the source is read once.
+	template <typename Base>
+	class ChunkView
+	{
+	public:
+		class Iterator
+		{
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = std::vector<BaseValue<Base>>;
+			using difference_type = std::ptrdiff_t;
+			using reference = const value_type&;
+			using pointer = const value_type*;
+
+			Iterator() = default;
+			Iterator(BaseIterator<Base> current, BaseIterator<Base> last, int size)
+				: m_Current(current), m_End(last), m_Size(size)
+			{
+				Fill();
+			}
+
+			reference operator*() const { return m_Chunk; }
+			pointer operator->() const { return &m_Chunk; }
+
+			Iterator& operator++()
+			{
+				Fill();
+				return *this;
+			}
+
+			Iterator operator++(int)
+			{
+				Iterator copy = *this;
+				++*this;
+				return copy;
+			}
+
+			bool operator==(const Iterator& other) const
+			{
+				return m_Current == other.m_Current && m_Chunk.empty() == other.m_Chunk.empty();
+			}
+
+			bool operator!=(const Iterator& other) const { return !(*this == other); }
+
+		private:
+			void Fill()
+			{
+				m_Chunk.clear();
+				for (int i = 0; i < m_Size && m_Current != m_End; ++i, ++m_Current)
+				{
+					m_Chunk.push_back(*m_Current);
+				}
+			}
+
+			BaseIterator<Base> m_Current;
+			BaseIterator<Base> m_End;
+			int m_Size = 0;
+			value_type m_Chunk;
+		};
+
+		ChunkView(Base base, int size) : m_Base(std::move(base)), m_Size(std::max(size, 1)) {}
+
+		Iterator begin() const { return Iterator(m_Base.begin(), m_Base.end(), m_Size); }
+		Iterator end() const { return Iterator(m_Base.end(), m_Base.end(), m_Size); }
+
+	private:
+		Base m_Base;
+		int m_Size;
+	};
+
+	// Pipe adaptors: `range | Filter(predicate)` builds FilterView(range, predicate), and so on.
+	template <typename Predicate>
+	struct FilterAdaptor { Predicate predicate; };
+
+	template <typename Function>
+	struct TransformAdaptor { Function function; };
+
+	struct TakeAdaptor { int count; };
+	struct UniqueAdaptor {};
+	struct ChunkAdaptor { int size; };
+
+	template <typename Predicate>
+	FilterAdaptor<Predicate> Filter(Predicate predicate) { return { std::move(predicate) }; }
+
+	template <typename Function>
+	TransformAdaptor<Function> Transform(Function function) { return { std::move(function) }; }
+
+	inline TakeAdaptor Take(int count) { return { count }; }
+	inline UniqueAdaptor Unique() { return {}; }
+	inline ChunkAdaptor Chunk(int size) { return { size }; }
+
+	template <typename Base, typename Predicate>
+	FilterView<Base, Predicate> operator|(Base base, FilterAdaptor<Predicate> adaptor)
+	{
+		return FilterView<Base, Predicate>(std::move(base), std::move(adaptor.predicate));
+	}
+
+	template <typename Base, typename Function>
+	TransformView<Base, Function> operator|(Base base, TransformAdaptor<Function> adaptor)
+	{
+		return TransformView<Base, Function>(std::move(base), std::move(adaptor.function));
+	}
+
+	template <typename Base>
+	TakeView<Base> operator|(Base base, TakeAdaptor adaptor)
+	{
+		return TakeView<Base>(std::move(base), adaptor.count);
+	}
+
+	template <typename Base>
+	UniqueView<Base> operator|(Base base, UniqueAdaptor)
+	{
+		return UniqueView<Base>(std::move(base));
+	}
+
+	template <typename Base>
+	ChunkView<Base> operator|(Base base, ChunkAdaptor adaptor)
+	{
+		return ChunkView<Base>(std::move(base), adaptor.size);
+	}
+
+	// Materializes a view into a new chain, from the thread's ListNodePool inside a Scope.
+	template <typename View>
+	ListNode<BaseValue<View>>* ToList(const View& view)
+	{
+		ListNode<BaseValue<View>> dummy;
+		ListNode<BaseValue<View>>* tail = &dummy;
+		for (auto&& value : view)
+		{
+			tail->pNext = new ListNode<BaseValue<View>>(value);
+			tail = tail->pNext;
+		}
+		return dummy.pNext;
+	}
+
+	template <typename View>
+	std::vector<BaseValue<View>> ToVector(const View& view)
+	{
+		return std::vector<BaseValue<View>>(view.begin(), view.end());
+	}
+}
+
+// Link embedded in every item handed through an MpscQueue; the atomic counterpart of ListNode::pNext.
+struct MpscLink
+{
+	std::atomic<MpscLink*> pNext{ nullptr };
+};
+
+// Convenience item holding its value inline, the way ListNode does.
+template <typename T>
+struct MpscNode : MpscLink
+{
+	T value;
+
+	MpscNode() : value() {}
+	explicit MpscNode(const T& value) : value(value) {}
+	explicit MpscNode(T&& value) : value(std::move(value)) {}
+};
+
+// Intrusive multi-producer/single-consumer queue after Dmitry Vyukov's design.
+// Push is one exchange plus one store and never waits on other threads; Pop only reads links.
+// Items are linked in place, so the queue never allocates, and an item must stay alive and
+// unqueued elsewhere until the consumer has popped it. Any number of threads may Push; only
+// one thread at a time may Pop or PopBatch.
+template <typename T>
+class MpscQueue
+{
+	static_assert(std::is_base_of<MpscLink, T>::value, "MpscQueue items must derive from MpscLink");
+
+public:
+	MpscQueue() : m_Head(&m_Stub), m_pTail(&m_Stub) {}
+
+	MpscQueue(const MpscQueue&) = delete;
+	MpscQueue& operator=(const MpscQueue&) = delete;
+
+	void Push(T* item)
+	{
+		PushLink(item);
+	}
+
+	// Returns nullptr when the queue is empty, and also in the brief window where a producer has
+	// claimed its place but not yet linked it; the item shows up on a later call.
+	T* Pop()
+	{
+		MpscLink* tail = m_pTail;
+		MpscLink* next = tail->pNext.load(std::memory_order_acquire);
+
+		if (tail == &m_Stub)
+		{
+			if (next == nullptr)
+			{
+				return nullptr;
+			}
+			m_pTail = next;
+			tail = next;
+			next = next->pNext.load(std::memory_order_acquire);
+		}
+
+		if (next != nullptr)
+		{
+			m_pTail = next;
+			return static_cast<T*>(tail);
+		}
+
+		if (tail != m_Head.load(std::memory_order_acquire))
+		{
+			return nullptr;
+		}
+
+		// tail is the last item: park the stub behind it so tail can be handed out.
+		PushLink(&m_Stub);
+		next = tail->pNext.load(std::memory_order_acquire);
+		if (next != nullptr)
+		{
+			m_pTail = next;
+			return static_cast<T*>(tail);
+		}
+		return nullptr;
+	}
+
+	// Hands up to maxCount items to consume(T*) in FIFO order and returns how many it handed out.
+	template <typename Function>
+	std::size_t PopBatch(Function consume, std::size_t maxCount = SIZE_MAX)
+	{
+		std::size_t count = 0;
+		while (count < maxCount)
+		{
+			T* item = Pop();
+			if (item == nullptr)
+			{
+				break;
+			}
+			consume(item);
+			++count;
+		}
+		return count;
+	}
+
+	// Only meaningful on the consumer thread.
+	bool IsEmpty() const
+	{
+		return m_pTail->pNext.load(std::memory_order_acquire) == nullptr && m_Head.load(std::memory_order_acquire) == m_pTail;
+	}
+
+private:
+	void PushLink(MpscLink* link)
+	{
+		link->pNext.store(nullptr, std::memory_order_relaxed);
+		MpscLink* previous = m_Head.exchange(link, std::memory_order_acq_rel);
+		previous->pNext.store(link, std::memory_order_release);
+	}
+
+	// Producers meet on m_Head and the consumer owns m_pTail, so each gets its own cache line.
+	alignas(64) std::atomic<MpscLink*> m_Head;
+	alignas(64) MpscLink* m_pTail;
+	MpscLink m_Stub;
+};
+
+// Fixed set of worker threads for the parallel list algorithms. The thread that calls RunAll
+// works through the queue alongside the workers instead of sleeping until they finish.
+class ListTaskPool
+{
+public:
+	explicit ListTaskPool(unsigned threadCount = std::max(1u, std::thread::hardware_concurrency()) - 1)
+	{
+		for (unsigned i = 0; i < threadCount; ++i)
+		{
+			m_Workers.emplace_back(&ListTaskPool::WorkerThread, this);
+		}
+	}
+
+	ListTaskPool(const ListTaskPool&) = delete;
+	ListTaskPool& operator=(const ListTaskPool&) = delete;
+
+	~ListTaskPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Stopping = true;
+		}
+		m_TaskCV.notify_all();
+		for (auto& worker : m_Workers)
+		{
+			worker.join();
+		}
+	}
+
+	// Workers plus the calling thread.
+	unsigned GetConcurrency() const
+	{
+		return static_cast<unsigned>(m_Workers.size()) + 1;
+	}
+
+	// Runs every task and returns once all of them have finished.
+	void RunAll(std::vector<std::function<void()>>& tasks)
+	{
+		if (tasks.empty())
+		{
+			return;
+		}
+
+		int remaining = static_cast<int>(tasks.size());
+		std::condition_variable doneCV;
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			for (auto& task : tasks)
+			{
+				m_Tasks.push_back([&, task = std::move(task)]
+					{
+						task();
+						std::lock_guard<std::mutex> lock(m_Mutex);
+						if (--remaining == 0)
+						{
+							doneCV.notify_one();
 						}
-					}
-					else
+					});
+			}
+		}
+		m_TaskCV.notify_all();
+
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		while (remaining > 0)
+		{
+			if (!m_Tasks.empty())
+			{
+				std::function<void()> task = std::move(m_Tasks.front());
+				m_Tasks.pop_front();
+				lock.unlock();
+				task();
+				lock.lock();
+			}
+			else
+			{
+				doneCV.wait(lock);
+			}
+		}
+		tasks.clear();
+	}
+
+	static ListTaskPool& Shared()
+	{
+		static ListTaskPool pool;
+		return pool;
+	}
+
+private:
+	void WorkerThread()
+	{
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		while (true)
+		{
+			m_TaskCV.wait(lock, [this] { return m_Stopping || !m_Tasks.empty(); });
+			if (m_Tasks.empty())
+			{
+				return;
+			}
+
+			std::function<void()> task = std::move(m_Tasks.front());
+			m_Tasks.pop_front();
+			lock.unlock();
+			task();
+			lock.lock();
+		}
+	}
+
+	std::mutex m_Mutex;
+	std::condition_variable m_TaskCV;
+	std::deque<std::function<void()>> m_Tasks;
+	std::vector<std::thread> m_Workers;
+	bool m_Stopping = false;
+};
+
+namespace ListNodeHelper
+{
+	template <typename T>
+	void Print(ListNode<T>* head)
+	{
+		const ListNode<T>* curent = head;
+		while (curent != nullptr)
+		{
+			curent->Print();
+			std::cout << " -> ";
+			curent = curent->pNext;
+		}
+		std::cout << "null" << std::endl;
+	}
+
+	template <typename T>
+	void Print(const std::string& label, ListNode<T>* head)
+	{
+		std::cout << label << ": ";
+		Print(head);
+	}
+
+	template <typename T>
+	int Size(ListNode<T>* head)
+	{
+		int size = 0;
+		ListNode<T>* current = head;
+		while (current != nullptr)
+		{
+			++size;
+			current = current->pNext;
+		}
+		return size;
+	}
+
+	struct LoopDetector
+	{
+		// LeetCode 141 - Detect if a loop exists in the linked list
+		template <typename T>
+		static ListNode<T>* DetectMeetingPoint(ListNode<T>* head)
+		{
+			ListNode<T>* slow = head;
+			ListNode<T>* fast = head;
+			while (fast && fast->pNext)
+			{
+				slow = slow->pNext;
+				fast = fast->pNext->pNext;
+				if (slow == fast)
+				{
+					return slow;
+				}
+			}
+			return nullptr;
+		}
+
+		// LeetCode 142 - Find the entry point of the loop
+		template <typename T>
+		static ListNode<T>* FindLoopEntry(ListNode<T>* head, ListNode<T>* meeting)
+		{
+			if (!meeting)
+			{
+				return nullptr;
+			}
+
+			ListNode<T>* slow = head;
+			ListNode<T>* fast = meeting;
+			while (slow != fast)
+			{
+				slow = slow->pNext;
+				fast = fast->pNext;
+			}
+			return slow;
+		}
+
+		template <typename T>
+		static ListNode<T>* FindLoopTail(ListNode<T>* entry)
+		{
+			if (!entry)
+			{
+				return nullptr;
+			}
+
+			ListNode<T>* current = entry;
+			while (current->pNext != entry)
+			{
+				current = current->pNext;
+			}
+			return current;
+		}
+	};
+
+	template <typename T>
+	void BreakLoop(ListNode<T>* head)
+	{
+		auto meeting = LoopDetector::DetectMeetingPoint(head);
+		if (!meeting)
+		{
+			return;
+		}
+
+		auto entry = LoopDetector::FindLoopEntry(head, meeting);
+		auto tail = LoopDetector::FindLoopTail(entry);
+		if (tail)
+		{
+			tail->pNext = nullptr;
+		}
+	}
+
+	template <typename T>
+	bool ContainsLoop(ListNode<T>* head)
+	{
+		return LoopDetector::DetectMeetingPoint(head) != nullptr;
+	}
+
+	template <typename T>
+	std::optional<int> GetLoopEntryIndex(ListNode<T>* head)
+	{
+		auto meeting = LoopDetector::DetectMeetingPoint(head);
+		if (!meeting) return std::nullopt;
+
+		auto entry = LoopDetector::FindLoopEntry(head, meeting);
+
+		int index = 0;
+		for (auto cur = head; cur != entry; cur = cur->pNext)
+		{
+			++index;
+		}
+		return index;
+	}
+
+	struct IntersectionDetector
+	{
+		// LeetCode 160 - Detect intersection of two linked lists
+		template <typename T>
+		static ListNode<T>* DetectIntersection(ListNode<T>* head1, ListNode<T>* head2)
+		{
+			if (!head1 || !head2)
+			{
+				return nullptr;
+			}
+
+			ListNode<T>* current1 = head1;
+			ListNode<T>* current2 = head2;
+
+			while (current1 != current2)
+			{
+				current1 = (current1 == nullptr) ? head2 : current1->pNext;
+				current2 = (current2 == nullptr) ? head1 : current2->pNext;
+			}
+			return current1;
+		}
+	};;
+
+	template <typename T>
+	void FreeList(ListNode<T>* head)
+	{
+		if (!head)
+		{
+			return;
+		}
+
+		BreakLoop(head);
+
+		while (head != nullptr)
+		{
+			ListNode<T>* next = head->pNext;
+			delete head;
+			head = next;
+		}
+	}
+
+	// Leet Code 876
+	template <typename T>
+	ListNode<T>* GetMiddleNode(ListNode<T>* head)
+	{
+		ListNode<T>* slow = head;
+		ListNode<T>* fast = head;
+
+		while (fast && fast->pNext)
+		{
+			slow = slow->pNext;
+			fast = fast->pNext->pNext;
+		}
+		return slow;
+	}
+
+	// Leet Code 82 - If a node is ever duplicated, remove them entirely
+	template <typename T>
+	ListNode<T>* RemoveDuplicates(ListNode<T>* head)
+	{
+		if (head != nullptr)
+		{
+			ListNode<T>* previous = nullptr;
+			ListNode<T>* current = head;
+			ListNode<T>* node = nullptr;
+
+			while (current->pNext != nullptr)
+			{
+				if (current->value == current->pNext->value)
+				{
+					// additionally mark current node to delete after deleting all trailing duplicates. 
+					node = current;
+
+					// deleting trailing duplicates
+					ListNode<T>* next = current->pNext;
+					current->pNext = (next != nullptr) ? next->pNext : nullptr;
+					delete next;
+					next = nullptr;
+				}
+				else
+				{
+					if (node != nullptr)
+					{
+						if (previous != nullptr)
+						{
+							previous->pNext = current->pNext;
+							delete node;
+							node = nullptr;
+
+							current = previous->pNext;
+						}
+						else // previous is nullptr, promoting new head.
+						{
+							head = current->pNext;
+							delete node;
+							node = nullptr;
+
+							// old head removed, assign to new head.
+							current = head;
+						}
+					}
+					else
+					{
+						previous = current;
+						current = current->pNext;
+					}
+				}
+			}
+
+			// if current node is still marked delete when there is no next node (unable to handle in loop) 
+			if (node != nullptr)
+			{
+				// promoting head to last known previous node
+				if (previous != nullptr)
+				{
+					previous->pNext = nullptr;
+					delete node;
+					node = nullptr;
+				}
+				else // promoting head to nullptr when there is no more previous node
+				{
+					return nullptr;
+				}
+			}
+		}
+
+		return head;
+	}
+
+	// Leet Code 83 - Remove all duplicate nodes
+	template <typename T>
+	ListNode<T>* MakeUnique(ListNode<T>* head)
+	{
+		if (head != nullptr)
+		{
+			ListNode<T>* current = head;
+
+			while (current->pNext != nullptr)
+			{
+				if (current->value == current->pNext->value)
+				{
+					ListNode<T>* node = current->pNext;
+					current->pNext = node->pNext;
+					delete node;
+					node = nullptr;
+				}
+				else
+				{
+					current = current->pNext;
+				}
+			}
+		}
+
+		return head;
+	}
+
+	// Leet Code 203 - Remove all nodes with a specific value
+	template <typename T>
+	ListNode<T>* RemoveElement(ListNode<T>* head, const T& value)
+	{
+		ListNode<T>* dummy = new ListNode<T>();
+		dummy->pNext = head;
+
+		ListNode<T>* previous = dummy;
+		ListNode<T>* current = head;
+
+		while (current != nullptr)
+		{
+			if (current->value == value)
+			{
+				// Correct the link to skip the current node
+				previous->pNext = current->pNext;
+				delete current;
+				current = previous->pNext;
+			}
+			else
+			{
+				// Move both pointers
+				previous = current;
+				current = current->pNext;
+			}
+		}
+
+		ListNode<T>* newHead = dummy->pNext;
+		delete dummy;
+		return newHead;
+	}
+
+	// Leet Code 3217 - Remove elements from array
+	template <typename T>
+	ListNode<T>* RemoveElement(ListNode<T>* head, std::vector<T>& elements)
+	{
+		if (head == nullptr || elements.size() == 0)
+		{
+			return head;
+		}
+
+		std::unordered_set<T> set(elements.begin(), elements.end());
+		
+		ListNode<T> dummy;
+		dummy.pNext = head;
+
+		ListNode<T>* tail = &dummy;
+		
+		while (tail->pNext != nullptr)
+		{
+			if (auto itr = set.find(tail->pNext->value); itr != set.end())
+			{
+				ListNode<T>* toDelete = tail->pNext;
+				tail->pNext = tail->pNext->pNext;
+				delete toDelete; // delete works for local, beware of double deletion from platform.
+			}
+			else
+			{
+				tail = tail->pNext;
+			}
+		}
+
+		return dummy.pNext;
+	}
+
+	// Leet Code 19 - Remove the nth node from the end of the list
+	template <typename T>
+	ListNode<T>* RemoveNthElementFromEnd(ListNode<T>* head, int n)
+	{
+		ListNode<T> dummy;
+		dummy.pNext = head;
+
+		ListNode<T>* slow = &dummy;
+		ListNode<T>* fast = &dummy;
+
+		for (int i = 0; i < n + 1; ++i)
+		{
+			if (fast == nullptr)
+			{
+				return nullptr;
+			}
+			fast = fast->pNext;
+		}
+
+		while (fast != nullptr)
+		{
+			slow = slow->pNext;
+			fast = fast->pNext;
+		}
+
+		if (slow && slow->pNext != nullptr)
+		{
+			ListNode<T>* toDelete = slow->pNext;
+			slow->pNext = slow->pNext->pNext;
+			delete toDelete;
+		}
+		
+		return dummy.pNext;
+	}
+
+	// Leet Code 21 - Merge Sorted
+	template <typename T>
+	ListNode<T>* Merge(ListNode<T>* head1, ListNode<T>* head2)
+	{
+		ListNode<T> dummy;
+		ListNode<T>* tail = &dummy;
+
+		while (head1 != nullptr && head2 != nullptr)
+		{
+			// Ties take from head1 so equal values keep their order.
+			if (head2->value < head1->value)
+			{
+				tail->pNext = head2;
+				head2 = head2->pNext;
+			}
+			else
+			{
+				tail->pNext = head1;
+				head1 = head1->pNext;
+			}
+			tail = tail->pNext;
+		}
+		tail->pNext = head1 ? head1 : head2;
+		return dummy.pNext;
+	}
+
+	// Leet Code 23 - Merge k-lists sorted
+	template <typename T>
+	ListNode<T>* Merge(std::vector<ListNode<T>*>& lists)
+	{
+		// cmpr follows std::greater convention so that smallest appeared at top.
+		auto cmpr = [](ListNode<T>* a, ListNode<T>* b) 
+			{
+				// WARNING : If the list never contains nullptr, these checks are obselete.
+				if (a == nullptr) return false; // a (nullptr) is lesser than b
+				if (b == nullptr) return true; // a is greater than (nullptr) b
+				return a->value > b->value;
+			};
+
+		//priority_queue<T, SequenceContainerOfT, Compare>
+		std::priority_queue<ListNode<T>*, std::vector<ListNode<T>*>, decltype(cmpr)> minHeap(cmpr);
+
+		for (auto& node : lists)
+		{
+			if (node != nullptr)
+			{
+				minHeap.push(node);
+			}
+		}
+
+		ListNode<T> dummy; 
+		ListNode<T>* tail = &dummy;
+
+		while (!minHeap.empty())
+		{
+			ListNode<T>* smallest = minHeap.top();
+			minHeap.pop();
+
+			tail->pNext = smallest;
+			tail = tail->pNext;
+
+			if (smallest->pNext != nullptr)
+			{ 
+				minHeap.push(smallest->pNext);
+			}
+		}
+		
+		return dummy.pNext;
+	}
+
+	// Leet Code 148 - Sort a linked list into ascending order
+	template <typename T>
+	ListNode<T>* Sort(ListNode<T>* head)
+	{
+		if (!head || !head->pNext)
+		{
+			return head;
+		}
+
+		ListNode<T>* slow = head;
+		ListNode<T>* fast = head;
+		ListNode<T>* previous = nullptr;
+
+		while (fast && fast->pNext)
+		{
+			previous = slow;
+			slow = slow->pNext;
+			fast = fast->pNext->pNext;
+		}
+
+		if (previous)
+		{
+			previous->pNext = nullptr;
+		}
+
+		ListNode<T>* left = Sort(head);
+		ListNode<T>* right = Sort(slow);
+
+		return Merge(left, right);
+	}
+
+	// Cuts the chain after its leading non-decreasing run and returns the remainder.
+	template <typename T>
+	ListNode<T>* CutAfterRun(ListNode<T>* head)
+	{
+		if (head == nullptr)
+		{
+			return nullptr;
+		}
+
+		while (head->pNext != nullptr && !(head->pNext->value < head->value))
+		{
+			head = head->pNext;
+		}
+
+		ListNode<T>* rest = head->pNext;
+		head->pNext = nullptr;
+		return rest;
+	}
+
+	// Leet Code 148 without recursion or middle-finding, in O(1) extra space.
+	// Works like a binary counter: bins[i] holds a sorted list built from 2^i runs, and each run
+	// taken off the front carries up through the occupied bins. Merges happen while their inputs
+	// are still warm in cache, unlike width-doubling passes over the whole list.
+	// A run is a single node, or with naturalRuns the longest non-decreasing stretch at the front,
+	// so sorted or nearly sorted input needs only a handful of merges. Stable either way.
+	template <typename T>
+	ListNode<T>* SortBottomUp(ListNode<T>* head, bool naturalRuns = false)
+	{
+		ListNode<T>* bins[64] = {};
+
+		while (head != nullptr)
+		{
+			ListNode<T>* run = head;
+			if (naturalRuns)
+			{
+				head = CutAfterRun(run);
+			}
+			else
+			{
+				head = run->pNext;
+				run->pNext = nullptr;
+			}
+
+			// Older runs go first so that ties keep their order.
+			int i = 0;
+			for (; bins[i] != nullptr; ++i)
+			{
+				run = Merge(bins[i], run);
+				bins[i] = nullptr;
+			}
+			bins[i] = run;
+		}
+
+		ListNode<T>* result = nullptr;
+		for (ListNode<T>* bin : bins)
+		{
+			if (bin != nullptr)
+			{
+				result = Merge(bin, result);
+			}
+		}
+		return result;
+	}
+
+	// Leet Code 328 - Odd even linked list
+	template <typename T>
+	ListNode<T>* OddEvenSort(ListNode<T>* head)
+	{
+		ListNode<T> dummyOdd;
+		ListNode<T>* tailOdd = &dummyOdd;
+
+		ListNode<T> dummyEven;
+		ListNode<T>* tailEven = &dummyEven;
+
+		bool isOddTurn = true;
+		while (head != nullptr)
+		{
+			if (isOddTurn)
+			{
+				// here we add odd node to the tail, then we move this node to the next
+				tailOdd->pNext = head;
+				tailOdd = tailOdd->pNext;
+			}
+			else
+			{
+				tailEven->pNext = head;
+				tailEven = tailEven->pNext;
+			}
+
+			head = head->pNext;
+			isOddTurn = !isOddTurn;
+		}
+
+		tailEven->pNext = nullptr;
+
+		// head is now pointing to the odd list last node
+		tailOdd->pNext = dummyEven.pNext;
+		return dummyOdd.pNext;
+	}
+
+	// Leet Code 725
+	template <typename T>
+	std::vector<ListNode<T>*> SplitByKParts(ListNode<T>* head, int k)
+	{
+		// Size and length calculation.
+		int size = 0;
+		for (auto current = head; current != nullptr; current = current->pNext)
+		{
+			++size;
+		}
+
+		int baseLen = size / k;
+		int extra = size % k;
+
+		// Init result vector
+		std::vector<ListNode<T>*> result(k, nullptr);
+
+		// Processing parts
+		ListNode<T>* current = head;
+		for (int i = 0; i < k && current != nullptr; ++i)
+		{
+			int partSize = baseLen + (i < extra ? 1 : 0);
+
+			result[i] = current;
+			for (int j = 1; j < partSize; ++j)
+			{
+				if (current != nullptr)
+				{
+					current = current->pNext;
+				}
+			}
+
+			// Moving to next part
+			if (current != nullptr)
+			{
+				ListNode<T>* nextPart = current->pNext;
+				current->pNext = nullptr;
+				current = nextPart;
+			}
+		}
+		return result;
+	}
+
+	// Leet Code 61 - Rotate List to the Right
+	template <typename T>
+	ListNode<T>* RotateRight(ListNode<T>* head, int k)
+	{
+		if (head == nullptr || head->pNext == nullptr || k == 0)
+		{
+			return head;
+		}
+
+		// Get the length of the list
+		int n = 1;
+		ListNode<T>* tail = head;
+		while (tail->pNext != nullptr)
+		{
+			tail = tail->pNext;
+			++n;
+		}
+
+		// Resolve k 
+		k %= n;
+		if (k < 0) k += n; // Convert to rotate right if negative
+		if (k == 0) return head;
+
+		// Create loop
+		tail->pNext = head;
+
+		// Find new tail
+		int stepsToNewTail = n - k - 1;
+		ListNode<T>* newTail = head;
+		for (int i = 0; i < stepsToNewTail; ++i)
+		{
+			newTail = newTail->pNext;
+		}
+
+		ListNode<T>* newHead = newTail->pNext;
+		newTail->pNext = nullptr;
+
+		return newHead;
+	}
+
+	// Leet Code 206 - Reverse a linked list
+	template <typename T>
+	ListNode<T>* Reverse(ListNode<T>* head)
+	{
+		ListNode<T> dummy;
+		while (head != nullptr)
+		{
+			ListNode<T>* tmp = head->pNext;
+			head->pNext = dummy.pNext;
+			dummy.pNext = head;
+			head = tmp;
+		}
+		return dummy.pNext;
+
+		// Note:
+		// Taking list 4->3->2 as example
+		// h = 4
+		// (4)->[(3)]...			>>> (4)->[(nil)]
+		// (d)->[(nil)]				>>> (d)->[(4)->(nil)]  
+		// h = 3
+		// (3)->[(2)]...			>>> (3)->[(4)->(nil)]
+	    // (d)->[(4)->(nil)]		>>> (d)->[(3)->(4)->(nil)]
+		// h = 2
+		// (2)->[(nil)]				>>> (2)->[(3)->(4)->(nil)]
+	    // (d)->[(3)->(4)->(nil)]	>>> (d)->[(2)->(3)->(4)->(nil)]
+	}
+
+	// Leet Code 25 - Reverse nodes in k-group
+	template <typename T>
+	ListNode<T>* Reverse(ListNode<T>* head, int k)
+	{
+		if (head == nullptr || k == 1)
+		{
+			return head;
+		}
+
+		ListNode<T> dummy;
+		dummy.pNext = head;
+		ListNode<T>* previousGroupTail = &dummy;
+
+		while (true)
+		{
+			// find k-th
+			ListNode<T>* kTh = previousGroupTail;
+			for (int i = 0; i < k && kTh != nullptr; ++i)
+			{
+				kTh = kTh->pNext;
+			}
+
+			if (kTh == nullptr)
+			{
+				break;
+			}
+			
+			// track group heads
+			ListNode<T>* groupHead = previousGroupTail->pNext;
+			ListNode<T>* nextGroupHead = kTh->pNext;
+
+			// reverse group
+			ListNode<T>* previous = nextGroupHead;
+			ListNode<T>* current = groupHead;
+			while (current != nextGroupHead)
+			{
+				ListNode<T>* tmp = current->pNext;
+				current->pNext = previous;
+				previous = current;
+				current = tmp;
+			}
+
+			previousGroupTail->pNext = kTh;
+			previousGroupTail = groupHead;
+
+		}
+		return dummy.pNext;
+	}
+
+	// Merges neighbouring sorted runs pairwise, one parallel round per level, until one list remains.
+	template <typename T>
+	ListNode<T>* MergeRunsInParallel(std::vector<ListNode<T>*> runs, ListTaskPool& pool)
+	{
+		if (runs.empty())
+		{
+			return nullptr;
+		}
+
+		std::vector<std::function<void()>> tasks;
+		while (runs.size() > 1)
+		{
+			std::vector<ListNode<T>*> merged((runs.size() + 1) / 2, nullptr);
+			for (std::size_t i = 0; i + 1 < runs.size(); i += 2)
+			{
+				tasks.emplace_back([&runs, &merged, i] { merged[i / 2] = Merge(runs[i], runs[i + 1]); });
+			}
+			if (runs.size() % 2 == 1)
+			{
+				merged.back() = runs.back();
+			}
+			pool.RunAll(tasks);
+			runs.swap(merged);
+		}
+		return runs[0];
+	}
+
+	// Leet Code 23 with a loser tree. Each internal node keeps the loser of the match played
+	// there, so emitting one value costs a single leaf-to-root replay of about log k comparisons
+	// against keys cached beside the tree rather than read through the node pointers.
+	// Ties go to the list that comes first in `lists`, so the merge is stable.
+	template <typename T>
+	ListNode<T>* MergeTournament(const std::vector<ListNode<T>*>& lists)
+	{
+		// Small trivially copyable keys are cached by value, anything else by address.
+		using Key = std::conditional_t<std::is_trivially_copyable<T>::value && sizeof(T) <= 16, T, const T*>;
+		auto keyOf = [](const ListNode<T>* node) -> Key
+			{
+				if constexpr (std::is_pointer<Key>::value) return &node->value;
+				else return node->value;
+			};
+		auto valueOf = [](const Key& key) -> const T&
+			{
+				if constexpr (std::is_pointer<Key>::value) return *key;
+				else return key;
+			};
+
+		std::vector<ListNode<T>*> heads;
+		for (ListNode<T>* list : lists)
+		{
+			if (list != nullptr)
+			{
+				heads.push_back(list);
+			}
+		}
+
+		const int k = static_cast<int>(heads.size());
+		if (k < 2)
+		{
+			return k == 1 ? heads[0] : nullptr;
+		}
+
+		std::vector<Key> keys(k);
+		std::vector<char> exhausted(k, 0);
+		for (int i = 0; i < k; ++i)
+		{
+			keys[i] = keyOf(heads[i]);
+		}
+
+		auto beats = [&](int a, int b)
+			{
+				if (exhausted[a]) return false;
+				if (exhausted[b]) return true;
+				const T& valueA = valueOf(keys[a]);
+				const T& valueB = valueOf(keys[b]);
+				return valueA < valueB || (!(valueB < valueA) && a < b);
+			};
+
+		// Leaves sit at k..2k-1 of an implicit heap, internal nodes at 1..k-1, the winner at 0.
+		std::vector<int> tree(k);
+		{
+			std::vector<int> winners(2 * k);
+			for (int i = 0; i < k; ++i)
+			{
+				winners[k + i] = i;
+			}
+			for (int node = k - 1; node >= 1; --node)
+			{
+				int left = winners[2 * node];
+				int right = winners[2 * node + 1];
+				bool leftWins = beats(left, right);
+				winners[node] = leftWins ? left : right;
+				tree[node] = leftWins ? right : left;
+			}
+			tree[0] = winners[1];
+		}
+
+		ListNode<T> dummy;
+		ListNode<T>* tail = &dummy;
+		while (!exhausted[tree[0]])
+		{
+			int winner = tree[0];
+			tail->pNext = heads[winner];
+			tail = tail->pNext;
+
+			heads[winner] = heads[winner]->pNext;
+			if (heads[winner] != nullptr)
+			{
+				keys[winner] = keyOf(heads[winner]);
+			}
+			else
+			{
+				exhausted[winner] = 1;
+			}
+
+			for (int node = (k + winner) / 2; node >= 1; node /= 2)
+			{
+				if (beats(tree[node], winner))
+				{
+					std::swap(tree[node], winner);
+				}
+			}
+			tree[0] = winner;
+		}
+
+		tail->pNext = nullptr;
+		return dummy.pNext;
+	}
+
+	// Leet Code 23 for very large k: one tournament per thread over a contiguous group of lists,
+	// then a parallel pairwise reduction of the group results. Stable, like MergeTournament.
+	template <typename T>
+	ListNode<T>* ParallelMerge(const std::vector<ListNode<T>*>& lists, ListTaskPool& pool = ListTaskPool::Shared(), int sequentialThreshold = 256)
+	{
+		int k = static_cast<int>(lists.size());
+		int groups = std::min(static_cast<int>(pool.GetConcurrency()), k / sequentialThreshold);
+		if (groups < 2)
+		{
+			return MergeTournament(lists);
+		}
+
+		std::vector<ListNode<T>*> runs(groups, nullptr);
+		std::vector<std::function<void()>> tasks;
+		for (int group = 0; group < groups; ++group)
+		{
+			tasks.emplace_back([&lists, &runs, group, groups, k]
+				{
+					auto first = lists.begin() + static_cast<std::ptrdiff_t>(k) * group / groups;
+					auto last = lists.begin() + static_cast<std::ptrdiff_t>(k) * (group + 1) / groups;
+					runs[group] = MergeTournament(std::vector<ListNode<T>*>(first, last));
+				});
+		}
+		pool.RunAll(tasks);
+
+		return MergeRunsInParallel(std::move(runs), pool);
+	}
+
+	// Leet Code 148 on several cores: cut the list into one run per thread, sort the runs
+	// concurrently, then merge neighbouring runs pairwise in parallel rounds.
+	// Nodes are only relinked, never allocated, so node pools stay single threaded.
+	template <typename T>
+	ListNode<T>* ParallelSort(ListNode<T>* head, ListTaskPool& pool = ListTaskPool::Shared(), int sequentialThreshold = 1 << 15)
+	{
+		int size = Size(head);
+		int parts = std::min(static_cast<int>(pool.GetConcurrency()), size / sequentialThreshold);
+		if (parts < 2)
+		{
+			return SortBottomUp(head, true);
+		}
+
+		std::vector<ListNode<T>*> runs = SplitByKParts(head, parts);
+		std::vector<std::function<void()>> tasks;
+		for (auto& run : runs)
+		{
+			tasks.emplace_back([&run] { run = SortBottomUp(run, true); });
+		}
+		pool.RunAll(tasks);
+
+		return MergeRunsInParallel(std::move(runs), pool);
+	}
+}
+
+// Owning singly linked list that keeps its tail and size current through every mutation,
+// so appending, Size and Tail are O(1) and the helpers below skip the length pass that
+// their ListNodeHelper counterparts need. Nodes are freed when the List goes away.
+template <typename T>
+class List
+{
+public:
+	List() = default;
+
+	// Takes ownership of an existing chain, walking it once to find the tail and size.
+	explicit List(ListNode<T>* head) : m_pHead(head)
+	{
+		for (ListNode<T>* current = head; current != nullptr; current = current->pNext)
+		{
+			m_pTail = current;
+			++m_Size;
+		}
+	}
+
+	List(std::initializer_list<T> values)
+	{
+		for (const T& value : values)
+		{
+			PushBack(value);
+		}
+	}
+
+	List(const List&) = delete;
+	List& operator=(const List&) = delete;
+
+	List(List&& other) noexcept : m_pHead(other.m_pHead), m_pTail(other.m_pTail), m_Size(other.m_Size)
+	{
+		other.Reset();
+	}
+
+	List& operator=(List&& other) noexcept
+	{
+		if (this != &other)
+		{
+			Clear();
+			m_pHead = other.m_pHead;
+			m_pTail = other.m_pTail;
+			m_Size = other.m_Size;
+			other.Reset();
+		}
+		return *this;
+	}
+
+	~List()
+	{
+		Clear();
+	}
+
+	ListNode<T>* GetHead() const { return m_pHead; }
+	ListNode<T>* GetTail() const { return m_pTail; }
+	int GetSize() const { return m_Size; }
+	bool IsEmpty() const { return m_Size == 0; }
+
+	ListNodeIterator<T> begin() { return ListNodeIterator<T>(m_pHead); }
+	ListNodeIterator<T> end() { return ListNodeIterator<T>(); }
+	ListNodeIterator<const T> begin() const { return ListNodeIterator<const T>(m_pHead); }
+	ListNodeIterator<const T> end() const { return ListNodeIterator<const T>(); }
+
+	template <typename U>
+	void PushBack(U&& value)
+	{
+		LinkBack(new ListNode<T>(std::forward<U>(value)));
+	}
+
+	template <typename U>
+	void PushFront(U&& value)
+	{
+		ListNode<T>* node = new ListNode<T>(std::forward<U>(value));
+		node->pNext = m_pHead;
+		m_pHead = node;
+		if (m_pTail == nullptr)
+		{
+			m_pTail = node;
+		}
+		++m_Size;
+	}
+
+	void PopFront()
+	{
+		if (m_pHead == nullptr)
+		{
+			return;
+		}
+
+		ListNode<T>* node = m_pHead;
+		m_pHead = node->pNext;
+		if (m_pHead == nullptr)
+		{
+			m_pTail = nullptr;
+		}
+		--m_Size;
+		delete node;
+	}
+
+	// Splices all of `other` onto the end in O(1).
+	void Append(List&& other)
+	{
+		if (other.m_pHead == nullptr || &other == this)
+		{
+			return;
+		}
+
+		if (m_pTail != nullptr)
+		{
+			m_pTail->pNext = other.m_pHead;
+		}
+		else
+		{
+			m_pHead = other.m_pHead;
+		}
+		m_pTail = other.m_pTail;
+		m_Size += other.m_Size;
+		other.Reset();
+	}
+
+	// Hands the chain back to the caller, who becomes responsible for freeing it.
+	ListNode<T>* Release()
+	{
+		ListNode<T>* head = m_pHead;
+		Reset();
+		return head;
+	}
+
+	void Clear()
+	{
+		ListNodeHelper::FreeList(m_pHead);
+		Reset();
+	}
+
+	void Print(const char* label) const
+	{
+		ListNodeHelper::Print(label, m_pHead);
+	}
+
+	// Leet Code 203
+	void RemoveElement(const T& value)
+	{
+		RemoveIf([&](const ListNode<T>* node, const ListNode<T>*) { return node->value == value; });
+	}
+
+	// Leet Code 83
+	void MakeUnique()
+	{
+		RemoveIf([](const ListNode<T>* node, const ListNode<T>* previous) { return previous != nullptr && node->value == previous->value; });
+	}
+
+	// Leet Code 19 - the size is known, so this is a single walk to the predecessor
+	void RemoveNthElementFromEnd(int n)
+	{
+		if (n < 1 || n > m_Size)
+		{
+			return;
+		}
+
+		int index = m_Size - n;
+		if (index == 0)
+		{
+			PopFront();
+			return;
+		}
+
+		ListNode<T>* previous = m_pHead;
+		for (int i = 1; i < index; ++i)
+		{
+			previous = previous->pNext;
+		}
+
+		ListNode<T>* toDelete = previous->pNext;
+		previous->pNext = toDelete->pNext;
+		if (toDelete == m_pTail)
+		{
+			m_pTail = previous;
+		}
+		--m_Size;
+		delete toDelete;
+	}
+
+	// Leet Code 61 - the old tail is already at hand, so only the walk to the new tail remains
+	void RotateRight(int k)
+	{
+		if (m_Size < 2)
+		{
+			return;
+		}
+
+		k %= m_Size;
+		if (k < 0) k += m_Size;
+		if (k == 0) return;
+
+		ListNode<T>* newTail = m_pHead;
+		for (int i = 0; i < m_Size - k - 1; ++i)
+		{
+			newTail = newTail->pNext;
+		}
+
+		m_pTail->pNext = m_pHead;
+		m_pHead = newTail->pNext;
+		newTail->pNext = nullptr;
+		m_pTail = newTail;
+	}
+
+	// Leet Code 206
+	void Reverse()
+	{
+		m_pTail = m_pHead;
+		m_pHead = ListNodeHelper::Reverse(m_pHead);
+	}
+
+	// Leet Code 148
+	void Sort()
+	{
+		m_pHead = ListNodeHelper::SortBottomUp(m_pHead, true);
+		FindTail();
+	}
+
+	// Leet Code 21 - merges the sorted `other` into this sorted list
+	void Merge(List&& other)
+	{
+		if (&other == this)
+		{
+			return;
+		}
+
+		m_pHead = ListNodeHelper::Merge(m_pHead, other.m_pHead);
+
+		// One of the two old tails ends the merged chain, the other now has a successor.
+		if (m_pTail == nullptr || m_pTail->pNext != nullptr)
+		{
+			m_pTail = other.m_pTail;
+		}
+		m_Size += other.m_Size;
+		other.Reset();
+	}
+
+	// Leet Code 725 - part lengths come from the cached size, with no counting pass
+	// Returns no parts and keeps the list when k is not positive.
+	std::vector<List> SplitByKParts(int k)
+	{
+		if (k <= 0)
+		{
+			return {};
+		}
+		std::vector<List> result(k);
+
+		int baseLen = m_Size / k;
+		int extra = m_Size % k;
+
+		ListNode<T>* current = m_pHead;
+		for (int i = 0; i < k && current != nullptr; ++i)
+		{
+			int partSize = baseLen + (i < extra ? 1 : 0);
+
+			List& part = result[i];
+			part.m_pHead = current;
+			part.m_Size = partSize;
+			for (int j = 1; j < partSize; ++j)
+			{
+				current = current->pNext;
+			}
+			part.m_pTail = current;
+
+			current = current->pNext;
+			part.m_pTail->pNext = nullptr;
+		}
+
+		Reset();
+		return result;
+	}
+
+private:
+	void LinkBack(ListNode<T>* node)
+	{
+		if (m_pTail != nullptr)
+		{
+			m_pTail->pNext = node;
+		}
+		else
+		{
+			m_pHead = node;
+		}
+		m_pTail = node;
+		++m_Size;
+	}
+
+	// Unlinks and frees every node for which shouldRemove(node, lastKept) holds, in one pass.
+	template <typename Predicate>
+	void RemoveIf(Predicate shouldRemove)
+	{
+		ListNode<T>* previous = nullptr;
+		ListNode<T>* current = m_pHead;
+		while (current != nullptr)
+		{
+			ListNode<T>* next = current->pNext;
+			if (shouldRemove(current, previous))
+			{
+				if (previous != nullptr)
+				{
+					previous->pNext = next;
+				}
+				else
+				{
+					m_pHead = next;
+				}
+				--m_Size;
+				delete current;
+			}
+			else
+			{
+				previous = current;
+			}
+			current = next;
+		}
+		m_pTail = previous;
+	}
+
+	void FindTail()
+	{
+		m_pTail = m_pHead;
+		while (m_pTail != nullptr && m_pTail->pNext != nullptr)
+		{
+			m_pTail = m_pTail->pNext;
+		}
+	}
+
+	void Reset()
+	{
+		m_pHead = nullptr;
+		m_pTail = nullptr;
+		m_Size = 0;
+	}
+
+	ListNode<T>* m_pHead = nullptr;
+	ListNode<T>* m_pTail = nullptr;
+	int m_Size = 0;
+};
+
+// A list node holding a small array of values instead of one, sized to span two cache lines.
+// Scans touch CAPACITY values per pointer hop and the inner loops run over contiguous memory.
+// Every node in a list holds at least one value.
+template <typename T>
+class UnrolledListNode
+{
+public:
+	static constexpr int NODE_BYTES = 128;
+	static constexpr int CAPACITY = static_cast<int>(sizeof(T) * 2 + 2 * sizeof(void*) > NODE_BYTES ? 2 : (NODE_BYTES - 2 * sizeof(void*)) / sizeof(T));
+
+	UnrolledListNode* pNext = nullptr;
+	int count = 0;
+	T values[CAPACITY];
+
+	bool IsFull() const
+	{
+		return count == CAPACITY;
+	}
+
+	void PushBack(const T& value)
+	{
+		values[count++] = value;
+	}
+
+	void PushBack(T&& value)
+	{
+		values[count++] = std::move(value);
+	}
+
+	void Print() const
+	{
+		std::cout << "[";
+		for (int i = 0; i < count; ++i)
+		{
+			std::cout << (i > 0 ? " " : "") << values[i];
+		}
+		std::cout << "]";
+	}
+};
+
+namespace UnrolledListHelper
+{
+	// Builds a packed list front to back, opening a new node whenever the tail is full.
+	template <typename T>
+	struct Appender
+	{
+		UnrolledListNode<T>* pHead = nullptr;
+		UnrolledListNode<T>* pTail = nullptr;
+
+		template <typename U>
+		void PushBack(U&& value)
+		{
+			if (pTail == nullptr || pTail->IsFull())
+			{
+				Link(new UnrolledListNode<T>());
+			}
+			pTail->PushBack(std::forward<U>(value));
+		}
+
+		// Attaches a whole chain, starting at values[first] of its head node. The head is folded
+		// into the tail, or its successor into it, where they fit, so a chain with no two
+		// neighbours that would fit into one node keeps that property across the seam.
+		void Append(UnrolledListNode<T>* chain, int first)
+		{
+			while (chain != nullptr && pTail != nullptr && pTail->count + chain->count - first <= UnrolledListNode<T>::CAPACITY)
+			{
+				std::move(chain->values + first, chain->values + chain->count, pTail->values + pTail->count);
+				pTail->count += chain->count - first;
+				UnrolledListNode<T>* rest = chain->pNext;
+				delete chain;
+				chain = rest;
+				first = 0;
+			}
+			if (chain == nullptr)
+			{
+				return;
+			}
+			if (first > 0)
+			{
+				std::move(chain->values + first, chain->values + chain->count, chain->values);
+				chain->count -= first;
+
+				// The shortened head may now fit together with its successor.
+				UnrolledListNode<T>* next = chain->pNext;
+				if (next != nullptr && chain->count + next->count <= UnrolledListNode<T>::CAPACITY)
+				{
+					std::move(next->values, next->values + next->count, chain->values + chain->count);
+					chain->count += next->count;
+					chain->pNext = next->pNext;
+					delete next;
+				}
+			}
+			Link(chain);
+			while (pTail->pNext != nullptr)
+			{
+				pTail = pTail->pNext;
+			}
+		}
+
+	private:
+		void Link(UnrolledListNode<T>* node)
+		{
+			if (pTail != nullptr)
+			{
+				pTail->pNext = node;
+			}
+			else
+			{
+				pHead = node;
+			}
+			pTail = node;
+		}
+	};
+
+	template <typename T>
+	void Print(const UnrolledListNode<T>* head)
+	{
+		for (const UnrolledListNode<T>* current = head; current != nullptr; current = current->pNext)
+		{
+			current->Print();
+			std::cout << " -> ";
+		}
+		std::cout << "null" << std::endl;
+	}
+
+	template <typename T>
+	void Print(const char* label, const UnrolledListNode<T>* head)
+	{
+		std::cout << label << ": ";
+		Print(head);
+	}
+
+	template <typename T>
+	int Size(const UnrolledListNode<T>* head)
+	{
+		int size = 0;
+		for (; head != nullptr; head = head->pNext)
+		{
+			size += head->count;
+		}
+		return size;
+	}
+
+	template <typename T>
+	void FreeList(UnrolledListNode<T>* head)
+	{
+		while (head != nullptr)
+		{
+			UnrolledListNode<T>* next = head->pNext;
+			delete head;
+			head = next;
+		}
+	}
+
+	// Packs a ListNode chain into full nodes; the source list is left untouched.
+	template <typename T>
+	UnrolledListNode<T>* FromList(const ListNode<T>* head)
+	{
+		Appender<T> out;
+		for (; head != nullptr; head = head->pNext)
+		{
+			out.PushBack(head->value);
+		}
+		return out.pHead;
+	}
+
+	template <typename T>
+	ListNode<T>* ToList(const UnrolledListNode<T>* head)
+	{
+		ListNode<T> dummy;
+		ListNode<T>* tail = &dummy;
+		for (; head != nullptr; head = head->pNext)
+		{
+			for (int i = 0; i < head->count; ++i)
+			{
+				tail->pNext = new ListNode<T>(head->values[i]);
+				tail = tail->pNext;
+			}
+		}
+		return dummy.pNext;
+	}
+
+	// Keeps the values for which keep(value, lastKept) holds, compacting each node in place.
+	// A node left empty is unlinked, and a node that fits into its predecessor is folded into it,
+	// so neighbouring nodes never both sit under half capacity.
+	template <typename T, typename Keep>
+	UnrolledListNode<T>* Filter(UnrolledListNode<T>* head, Keep keep)
+	{
+		UnrolledListNode<T>* previous = nullptr;
+		UnrolledListNode<T>* current = head;
+
+		while (current != nullptr)
+		{
+			int kept = 0;
+			for (int i = 0; i < current->count; ++i)
+			{
+				const T* lastKept = kept > 0 ? &current->values[kept - 1] : (previous != nullptr ? &previous->values[previous->count - 1] : nullptr);
+				if (keep(current->values[i], lastKept))
+				{
+					if (kept != i)
 					{
-						previous = current;
-						current = current->pNext;
+						current->values[kept] = std::move(current->values[i]);
 					}
+					++kept;
 				}
 			}
+			current->count = kept;
 
-			// if current node is still marked delete when there is no next node (unable to handle in loop) 
-			if (node != nullptr)
+			UnrolledListNode<T>* next = current->pNext;
+			if (kept == 0 || (previous != nullptr && previous->count + kept <= UnrolledListNode<T>::CAPACITY))
 			{
-				// promoting head to last known previous node
 				if (previous != nullptr)
 				{
-					previous->pNext = nullptr;
-					delete node;
-					node = nullptr;
+					std::move(current->values, current->values + kept, previous->values + previous->count);
+					previous->count += kept;
+					previous->pNext = next;
 				}
-				else // promoting head to nullptr when there is no more previous node
+				else
 				{
-					return nullptr;
+					head = next;
 				}
+				delete current;
+			}
+			else
+			{
+				previous = current;
 			}
+			current = next;
 		}
-
 		return head;
 	}
 
-	// Leet Code 83 - Remove all duplicate nodes
+	// Leet Code 203 equivalent
 	template <typename T>
-	ListNode<T>* MakeUnique(ListNode<T>* head)
+	UnrolledListNode<T>* RemoveElement(UnrolledListNode<T>* head, const T& value)
 	{
-		if (head != nullptr)
+		return Filter(head, [&](const T& candidate, const T*) { return !(candidate == value); });
+	}
+
+	// Leet Code 3217 equivalent
+	template <typename T>
+	UnrolledListNode<T>* RemoveElement(UnrolledListNode<T>* head, std::vector<T>& elements)
+	{
+		if (head == nullptr || elements.size() == 0)
 		{
-			ListNode<T>* current = head;
+			return head;
+		}
 
-			while (current->pNext != nullptr)
+		std::unordered_set<T> set(elements.begin(), elements.end());
+		return Filter(head, [&](const T& candidate, const T*) { return set.find(candidate) == set.end(); });
+	}
+
+	// Leet Code 83 equivalent - drop repeated values from a sorted list
+	template <typename T>
+	UnrolledListNode<T>* MakeUnique(UnrolledListNode<T>* head)
+	{
+		return Filter(head, [](const T& candidate, const T* lastKept) { return lastKept == nullptr || !(candidate == *lastKept); });
+	}
+
+	// Leet Code 206 equivalent - reverses the node order and the values inside each node
+	template <typename T>
+	UnrolledListNode<T>* Reverse(UnrolledListNode<T>* head)
+	{
+		UnrolledListNode<T>* reversed = nullptr;
+		while (head != nullptr)
+		{
+			UnrolledListNode<T>* next = head->pNext;
+			std::reverse(head->values, head->values + head->count);
+			head->pNext = reversed;
+			reversed = head;
+			head = next;
+		}
+		return reversed;
+	}
+
+	// Cuts the list after its first `index` values (index >= 1) and returns the remainder,
+	// splitting the node the cut falls into.
+	template <typename T>
+	UnrolledListNode<T>* SplitAt(UnrolledListNode<T>* head, int index)
+	{
+		UnrolledListNode<T>* current = head;
+		while (current != nullptr && index > current->count)
+		{
+			index -= current->count;
+			current = current->pNext;
+		}
+
+		if (current == nullptr)
+		{
+			return nullptr;
+		}
+
+		UnrolledListNode<T>* rest = current->pNext;
+		if (index < current->count)
+		{
+			UnrolledListNode<T>* tail = new UnrolledListNode<T>();
+			std::move(current->values + index, current->values + current->count, tail->values);
+			tail->count = current->count - index;
+			tail->pNext = rest;
+			current->count = index;
+			rest = tail;
+		}
+		current->pNext = nullptr;
+		return rest;
+	}
+
+	// Leet Code 61 equivalent
+	template <typename T>
+	UnrolledListNode<T>* RotateRight(UnrolledListNode<T>* head, int k)
+	{
+		int n = Size(head);
+		if (n < 2)
+		{
+			return head;
+		}
+
+		k %= n;
+		if (k < 0) k += n;
+		if (k == 0) return head;
+
+		UnrolledListNode<T>* newHead = SplitAt(head, n - k);
+		UnrolledListNode<T>* tail = newHead;
+		while (tail->pNext != nullptr)
+		{
+			tail = tail->pNext;
+		}
+		tail->pNext = head;
+		return newHead;
+	}
+
+	// Leet Code 725 equivalent. Returns no parts and leaves head to the caller when k is not positive.
+	template <typename T>
+	std::vector<UnrolledListNode<T>*> SplitByKParts(UnrolledListNode<T>* head, int k)
+	{
+		if (k <= 0)
+		{
+			return {};
+		}
+
+		int size = Size(head);
+		int baseLen = size / k;
+		int extra = size % k;
+
+		std::vector<UnrolledListNode<T>*> result(k, nullptr);
+		UnrolledListNode<T>* current = head;
+		for (int i = 0; i < k && current != nullptr; ++i)
+		{
+			result[i] = current;
+			current = SplitAt(current, baseLen + (i < extra ? 1 : 0));
+		}
+		return result;
+	}
+
+	// Leet Code 21 equivalent - stable, writes into packed nodes and frees input nodes as they drain
+	template <typename T>
+	UnrolledListNode<T>* Merge(UnrolledListNode<T>* head1, UnrolledListNode<T>* head2)
+	{
+		Appender<T> out;
+		int index1 = 0;
+		int index2 = 0;
+
+		auto take = [&out](UnrolledListNode<T>*& head, int& index)
 			{
-				if (current->pValue && current->pNext->pValue && *current->pValue == *current->pNext->pValue)
+				out.PushBack(std::move(head->values[index]));
+				if (++index == head->count)
 				{
-					ListNode<T>* node = current->pNext;
-					current->pNext = node->pNext;
-					delete node;
-					node = nullptr;
+					UnrolledListNode<T>* next = head->pNext;
+					delete head;
+					head = next;
+					index = 0;
 				}
-				else
+			};
+
+		while (head1 != nullptr && head2 != nullptr)
+		{
+			if (head2->values[index2] < head1->values[index1])
+			{
+				take(head2, index2);
+			}
+			else
+			{
+				take(head1, index1);
+			}
+		}
+
+		out.Append(head1, index1);
+		out.Append(head2, index2);
+		return out.pHead;
+	}
+
+	// Leet Code 148 equivalent - stable sort inside each node, then bottom-up merges of node runs.
+	// Like Filter, leaves no two neighbouring nodes that would fit into one.
+	template <typename T>
+	UnrolledListNode<T>* Sort(UnrolledListNode<T>* head)
+	{
+		std::vector<UnrolledListNode<T>*> runs;
+		while (head != nullptr)
+		{
+			UnrolledListNode<T>* next = head->pNext;
+			std::stable_sort(head->values, head->values + head->count);
+			head->pNext = nullptr;
+			runs.push_back(head);
+			head = next;
+		}
+
+		if (runs.empty())
+		{
+			return nullptr;
+		}
+
+		for (std::size_t width = 1; width < runs.size(); width *= 2)
+		{
+			for (std::size_t i = 0; i + width < runs.size(); i += 2 * width)
+			{
+				runs[i] = Merge(runs[i], runs[i + width]);
+			}
+		}
+		return runs[0];
+	}
+}
+
+namespace ListNodeCreator
+{
+	ListNode<int>* MakeNumericListLooped(int maxNumber)
+	{
+		ListNode<int>* head = new ListNode<int>(1);
+		ListNode<int>* current = head;
+		ListNode<int>* loop = head;
+
+		srand(time(NULL));
+		int selection = rand() % (maxNumber + 1);
+		std::cout << "Loop index picked at : " << (selection - 1 < 0 ? 0 : (selection - 1 > maxNumber ? maxNumber : selection - 1)) << std::endl;
+
+		for (int i = 0; i < maxNumber - 1; ++i)
+		{
+			current->pNext = new ListNode<int>(i + 2);
+			current = current->pNext;
+
+			if (i + 2 == selection)
+			{
+				loop = current;
+			}
+		}
+		current->pNext = loop;
+		return head;
+	}
+
+	ListNode<int>* MakeNumericList(std::vector<int>& intList)
+	{
+		if (intList.empty())
+		{
+			return nullptr;
+		}
+
+		ListNode<int>* head = new ListNode<int>(intList[0]);
+		ListNode<int>* current = head;
+		for (int i = 1; i < intList.size(); ++i)
+		{
+			ListNode<int>* pNode = new ListNode<int>(intList[i]);
+			current->pNext = pNode;
+			current = current->pNext;
+		}
+		return head;
+	}
+
+	ListNode<int>* MakeNumericList(std::initializer_list<int> intList)
+	{
+		if (intList.size() == 0)
+		{
+			return nullptr;
+		}
+
+		auto it = intList.begin();
+		ListNode<int>* head = new ListNode<int>(*it);
+		ListNode<int>* current = head;
+		++it;
+
+		for (; it != intList.end(); ++it)
+		{
+			ListNode<int>* pNode = new ListNode<int>(*it);
+			current->pNext = pNode;
+			current = current->pNext;
+		}
+		return head;
+	}
+}
+
+namespace ListNodeTester
+{
+	// Extends if test function returns more possible types.
+	template <typename T>
+	using TestResult = std::variant<ListNode<T>*, std::vector<ListNode<T>*>, bool, std::optional<int>>;
+
+	template <typename T>
+	static void MakeTest(const char* testName, const std::function<TestResult<T>()>& testFunction)
+	{
+		TestResult<T> result = testFunction();
+		std::cout << testName << " (Solution) : ";
+
+		std::visit([&](auto&& value)
+			{
+				using U = std::decay_t<decltype(value)>;
+				if constexpr (std::is_same_v<U, ListNode<T>*>)
 				{
-					current = current->pNext;
+					ListNodeHelper::Print(value);
+					ListNodeHelper::FreeList(value);
 				}
-			}
+				else if constexpr (std::is_same_v<U, std::vector<ListNode<T>*>>)
+				{
+					std::cout << "[" << std::endl;
+					for (auto part : value)
+					{
+						ListNodeHelper::Print(part);
+						ListNodeHelper::FreeList(part);
+					}
+					std::cout << "]" << std::endl;
+				}
+				else if constexpr (std::is_same_v<U, bool>)
+				{
+					std::cout << (value ? "true" : "false") << std::endl;
+
+					// WARNING : FREED THE LIST IN THE LAMBDA
+				}
+				else if constexpr (std::is_same_v<U, std::optional<int>>)
+				{
+					if (value)
+					{
+						std::cout << *value << std::endl;
+					}
+					else
+					{
+						std::cout << "nullopt" << std::endl;
+					}
+
+					// WARNING : FREED THE LIST IN THE LAMBDA
+				}
+
+			}, result);
+	}
+}
+
+// Randomized checks against std::vector reference results, run with --check. A failed check
+// names the operation and iteration instead of printing the lists.
+namespace ListNodeChecks
+{
+	bool Expect(bool condition, const char* what, int iteration)
+	{
+		if (!condition)
+		{
+			std::cout << "CHECK FAILED: " << what << " (iteration " << iteration << ")" << std::endl;
+		}
+		return condition;
+	}
+
+	std::vector<int> RandomValues(int maxSize, int maxValue)
+	{
+		std::vector<int> values(rand() % (maxSize + 1));
+		for (int& value : values)
+		{
+			value = rand() % (maxValue + 1);
 		}
-
-		return head;
+		return values;
 	}
 
-	// Leet Code 203 - Remove all nodes with a specific value
 	template <typename T>
-	ListNode<T>* RemoveElement(ListNode<T>* head, const T& value)
+	std::vector<T> ToVector(const ListNode<T>* head)
 	{
-		ListNode<T>* dummy = new ListNode<T>();
-		dummy->pNext = head;
-
-		ListNode<T>* previous = dummy;
-		ListNode<T>* current = head;
-
-		while (current != nullptr)
+		std::vector<T> values;
+		for (; head != nullptr; head = head->pNext)
 		{
-			if (*(current->pValue) == value)
-			{
-				// Correct the link to skip the current node
-				previous->pNext = current->pNext;
-				delete current;
-				current = previous->pNext;
-			}
-			else
-			{
-				// Move both pointers
-				previous = current;
-				current = current->pNext;
-			}
+			values.push_back(head->value);
 		}
-
-		ListNode<T>* newHead = dummy->pNext;
-		delete dummy;
-		return newHead;
+		return values;
 	}
 
-	// Leet Code 3217 - Remove elements from array
-	template <typename T>
-	ListNode<T>* RemoveElement(ListNode<T>* head, std::vector<T>& elements)
+	std::vector<int> ToVector(const UnrolledListNode<int>* head)
 	{
-		if (head == nullptr || elements.size() == 0)
+		std::vector<int> values;
+		for (; head != nullptr; head = head->pNext)
 		{
-			return head;
+			values.insert(values.end(), head->values, head->values + head->count);
 		}
+		return values;
+	}
 
-		std::unordered_set<int> set(elements.begin(), elements.end());
-		
-		ListNode<T> dummy;
-		dummy.pNext = head;
+	// Part lengths of Leet Code 725: the first size % k parts carry one extra value.
+	std::vector<int> PartSizes(int size, int k)
+	{
+		std::vector<int> sizes(k, size / k);
+		for (int i = 0; i < size % k; ++i)
+		{
+			++sizes[i];
+		}
+		return sizes;
+	}
 
-		ListNode<T>* tail = &dummy;
-		
-		while (tail->pNext != nullptr)
+	// What Appender builds: every node full except the last, which is not empty.
+	bool IsPacked(const UnrolledListNode<int>* head)
+	{
+		for (; head != nullptr; head = head->pNext)
 		{
-			if (auto itr = set.find(tail->pNext->pValue); itr != set.end())
+			if (head->count == 0 || (head->pNext != nullptr && !head->IsFull()))
 			{
-				ListNode<T>* toDelete = tail->pNext;
-				tail->pNext = tail->pNext->pNext;
-				delete toDelete; // delete works for local, beware of double deletion from platform.
+				return false;
 			}
-			else
+		}
+		return true;
+	}
+
+	// What Filter leaves: no empty node and no two neighbours that would fit into one.
+	bool IsCompacted(const UnrolledListNode<int>* head)
+	{
+		for (; head != nullptr; head = head->pNext)
+		{
+			if (head->count == 0 || (head->pNext != nullptr && head->count + head->pNext->count <= UnrolledListNode<int>::CAPACITY))
 			{
-				tail = tail->pNext;
+				return false;
 			}
 		}
-
-		return dummy.pNext;
+		return true;
 	}
 
-	// Leet Code 19 - Remove the nth node from the end of the list
-	template <typename T>
-	ListNode<T>* RemoveNthElementFromEnd(ListNode<T>* head, int n)
+	bool HasNoEmptyNode(const UnrolledListNode<int>* head)
 	{
-		ListNode<T> dummy;
-		dummy.pNext = head;
-
-		ListNode<T>* slow = &dummy;
-		ListNode<T>* fast = &dummy;
-
-		for (int i = 0; i < n + 1; ++i)
+		for (; head != nullptr; head = head->pNext)
 		{
-			if (fast == nullptr)
+			if (head->count == 0)
 			{
-				return nullptr;
+				return false;
 			}
-			fast = fast->pNext;
 		}
+		return true;
+	}
 
-		while (fast != nullptr)
+	bool CheckUnrolled(int iterations = 2000)
+	{
+		srand(725);
+		bool passed = true;
+		for (int iteration = 0; iteration < iterations && passed; ++iteration)
 		{
-			slow = slow->pNext;
-			fast = fast->pNext;
+			std::vector<int> expected = RandomValues(200, 20);
+			ListNode<int>* source = ListNodeCreator::MakeNumericList(expected);
+			UnrolledListNode<int>* list = UnrolledListHelper::FromList(source);
+			ListNodeHelper::FreeList(source);
+			passed &= Expect(ToVector(list) == expected && IsPacked(list), "Unrolled FromList", iteration);
+
+			int removed = rand() % 21;
+			expected.erase(std::remove(expected.begin(), expected.end(), removed), expected.end());
+			list = UnrolledListHelper::RemoveElement(list, removed);
+			passed &= Expect(ToVector(list) == expected && IsCompacted(list), "Unrolled RemoveElement", iteration);
+
+			std::stable_sort(expected.begin(), expected.end());
+			list = UnrolledListHelper::Sort(list);
+			passed &= Expect(ToVector(list) == expected && IsCompacted(list), "Unrolled Sort", iteration);
+
+			expected.erase(std::unique(expected.begin(), expected.end()), expected.end());
+			list = UnrolledListHelper::MakeUnique(list);
+			passed &= Expect(ToVector(list) == expected && IsCompacted(list), "Unrolled MakeUnique", iteration);
+
+			std::reverse(expected.begin(), expected.end());
+			list = UnrolledListHelper::Reverse(list);
+			passed &= Expect(ToVector(list) == expected && HasNoEmptyNode(list), "Unrolled Reverse", iteration);
+
+			int k = rand() % 41 - 10;
+			if (!expected.empty())
+			{
+				int n = static_cast<int>(expected.size());
+				std::rotate(expected.begin(), expected.begin() + ((n - k % n) % n), expected.end());
+			}
+			list = UnrolledListHelper::RotateRight(list, k);
+			passed &= Expect(ToVector(list) == expected && HasNoEmptyNode(list), "Unrolled RotateRight", iteration);
+
+			int parts = rand() % 7;
+			std::vector<UnrolledListNode<int>*> split = UnrolledListHelper::SplitByKParts(list, parts);
+			if (parts == 0)
+			{
+				passed &= Expect(split.empty(), "Unrolled SplitByKParts k = 0", iteration);
+				UnrolledListHelper::FreeList(list);
+				continue;
+			}
+			std::vector<int> sizes = PartSizes(static_cast<int>(expected.size()), parts);
+			std::vector<int> joined;
+			for (int i = 0; i < parts; ++i)
+			{
+				std::vector<int> part = ToVector(split[i]);
+				passed &= Expect(static_cast<int>(part.size()) == sizes[i] && HasNoEmptyNode(split[i]), "Unrolled SplitByKParts sizes", iteration);
+				joined.insert(joined.end(), part.begin(), part.end());
+				UnrolledListHelper::FreeList(split[i]);
+			}
+			passed &= Expect(joined == expected, "Unrolled SplitByKParts values", iteration);
 		}
+		std::cout << "UnrolledListNode checks: " << (passed ? "passed" : "FAILED") << std::endl;
+		return passed;
+	}
 
-		if (slow && slow->pNext != nullptr)
+	// Head, tail and size agree with the chain.
+	bool IsConsistent(const List<int>& list)
+	{
+		int size = 0;
+		const ListNode<int>* last = nullptr;
+		for (const ListNode<int>* current = list.GetHead(); current != nullptr; current = current->pNext)
 		{
-			ListNode<T>* toDelete = slow->pNext;
-			slow->pNext = slow->pNext->pNext;
-			delete toDelete;
+			last = current;
+			++size;
 		}
-		
-		return dummy.pNext;
+		return size == list.GetSize() && last == list.GetTail();
 	}
 
-	// Leet Code 21 - Merge Sorted
-	template <typename T>
-	ListNode<T>* Merge(ListNode<T>* head1, ListNode<T>* head2)
+	bool Matches(const List<int>& list, const std::vector<int>& expected)
 	{
-		ListNode<T> dummy;
-		ListNode<T>* tail = &dummy;
+		return IsConsistent(list) && ToVector(list.GetHead()) == expected;
+	}
 
-		while (head1 != nullptr && head2 != nullptr)
+	bool CheckList(int iterations = 2000)
+	{
+		srand(61);
+		bool passed = true;
+		for (int iteration = 0; iteration < iterations && passed; ++iteration)
 		{
-			if (*(head1->pValue) < *(head2->pValue))
+			std::vector<int> expected = RandomValues(60, 10);
+			List<int> list(ListNodeCreator::MakeNumericList(expected));
+			passed &= Expect(Matches(list, expected), "List from chain", iteration);
+
+			list.PushFront(-1);
+			list.PushBack(11);
+			expected.insert(expected.begin(), -1);
+			expected.push_back(11);
+			passed &= Expect(Matches(list, expected), "List PushFront/PushBack", iteration);
+
+			int removed = rand() % 11;
+			list.RemoveElement(removed);
+			expected.erase(std::remove(expected.begin(), expected.end(), removed), expected.end());
+			passed &= Expect(Matches(list, expected), "List RemoveElement", iteration);
+
+			list.Sort();
+			std::stable_sort(expected.begin(), expected.end());
+			passed &= Expect(Matches(list, expected), "List Sort", iteration);
+
+			std::vector<int> otherValues = RandomValues(30, 12);
+			std::sort(otherValues.begin(), otherValues.end());
+			list.Merge(List<int>(ListNodeCreator::MakeNumericList(otherValues)));
+			std::vector<int> merged;
+			std::merge(expected.begin(), expected.end(), otherValues.begin(), otherValues.end(), std::back_inserter(merged));
+			expected = merged;
+			passed &= Expect(Matches(list, expected), "List Merge", iteration);
+
+			list.MakeUnique();
+			expected.erase(std::unique(expected.begin(), expected.end()), expected.end());
+			passed &= Expect(Matches(list, expected), "List MakeUnique", iteration);
+
+			int k = rand() % 41 - 10;
+			list.RotateRight(k);
+			if (expected.size() > 1)
 			{
-				tail->pNext = head1;
-				head1 = head1->pNext;
+				int n = static_cast<int>(expected.size());
+				std::rotate(expected.begin(), expected.begin() + ((n - k % n) % n), expected.end());
 			}
-			else
+			passed &= Expect(Matches(list, expected), "List RotateRight", iteration);
+
+			int n = rand() % (static_cast<int>(expected.size()) + 3) - 1;
+			list.RemoveNthElementFromEnd(n);
+			if (n >= 1 && n <= static_cast<int>(expected.size()))
 			{
-				tail->pNext = head2;
-				head2 = head2->pNext;
+				expected.erase(expected.end() - n);
 			}
-			tail = tail->pNext;
+			passed &= Expect(Matches(list, expected), "List RemoveNthElementFromEnd", iteration);
+
+			list.Reverse();
+			std::reverse(expected.begin(), expected.end());
+			passed &= Expect(Matches(list, expected), "List Reverse", iteration);
+
+			int parts = rand() % 9 - 2;
+			std::vector<List<int>> split = list.SplitByKParts(parts);
+			if (parts <= 0)
+			{
+				passed &= Expect(split.empty() && Matches(list, expected), "List SplitByKParts k <= 0", iteration);
+				continue;
+			}
+			passed &= Expect(list.IsEmpty() && IsConsistent(list), "List SplitByKParts source", iteration);
+			std::vector<int> sizes = PartSizes(static_cast<int>(expected.size()), parts);
+			List<int> joined;
+			for (int i = 0; i < parts; ++i)
+			{
+				passed &= Expect(IsConsistent(split[i]) && split[i].GetSize() == sizes[i], "List SplitByKParts part", iteration);
+				joined.Append(std::move(split[i]));
+			}
+			passed &= Expect(Matches(joined, expected), "List SplitByKParts joined", iteration);
 		}
-		tail->pNext = head1 ? head1 : head2;
-		return dummy.pNext;
+		std::cout << "List checks: " << (passed ? "passed" : "FAILED") << std::endl;
+		return passed;
 	}
 
-	// Leet Code 23 - Merge k-lists sorted
-	template <typename T>
-	ListNode<T>* Merge(std::vector<ListNode<T>*>& lists)
+	bool CheckViews(int iterations = 2000)
 	{
-		// cmpr follows std::greater convention so that smallest appeared at top.
-		auto cmpr = [](ListNode<T>* a, ListNode<T>* b) 
-			{
-				// WARNING : If the list never contains nullptr, these checks are obselete.
-				if (a == nullptr) return false; // a (nullptr) is lesser than b
-				if (b == nullptr) return true; // a is greater than (nullptr) b
-				return *(a->pValue) > *(b->pValue);
-			};
-
-		//priority_queue<T, SequenceContainerOfT, Compare>
-		std::priority_queue<ListNode<T>*, std::vector<ListNode<T>*>, decltype(cmpr)> minHeap(cmpr);
+		using namespace ListNodeView;
 
-		for (auto& node : lists)
+		srand(49);
+		bool passed = true;
+		for (int iteration = 0; iteration < iterations && passed; ++iteration)
 		{
-			if (node != nullptr)
+			std::vector<int> values = RandomValues(80, 8);
+			ListNode<int>* list = ListNodeCreator::MakeNumericList(values);
+			int divisor = rand() % 3 + 2;
+			int count = rand() % 40 - 2;
+			int size = rand() % 7 - 1;
+			auto keep = [divisor](int value) { return value % divisor != 0; };
+			auto square = [](int value) { return value * value; };
+
+			std::vector<int> expected;
+			std::copy_if(values.begin(), values.end(), std::back_inserter(expected), keep);
+			passed &= Expect(ToVector(All(list) | Filter(keep)) == expected, "View Filter", iteration);
+
+			expected.clear();
+			std::transform(values.begin(), values.end(), std::back_inserter(expected), square);
+			passed &= Expect(ToVector(All(list) | Transform(square)) == expected, "View Transform", iteration);
+
+			expected.assign(values.begin(), values.begin() + std::clamp(count, 0, static_cast<int>(values.size())));
+			passed &= Expect(ToVector(All(list) | Take(count)) == expected, "View Take", iteration);
+
+			expected = values;
+			expected.erase(std::unique(expected.begin(), expected.end()), expected.end());
+			passed &= Expect(ToVector(All(list) | Unique()) == expected, "View Unique", iteration);
+
+			std::vector<std::vector<int>> expectedChunks;
+			for (std::size_t i = 0; i < values.size(); i += std::max(size, 1))
 			{
-				minHeap.push(node);
+				expectedChunks.emplace_back(values.begin() + i, values.begin() + std::min(values.size(), i + std::max(size, 1)));
+			}
+			passed &= Expect(ToVector(All(list) | Chunk(size)) == expectedChunks, "View Chunk", iteration);
+
+			// Composed, walked twice, and materialized: every walk sees the same values.
+			std::vector<int> filtered;
+			std::copy_if(values.begin(), values.end(), std::back_inserter(filtered), keep);
+			filtered.erase(std::unique(filtered.begin(), filtered.end()), filtered.end());
+			expected.clear();
+			std::transform(filtered.begin(), filtered.begin() + std::clamp(count, 0, static_cast<int>(filtered.size())), std::back_inserter(expected), square);
+			auto pipeline = All(list) | Filter(keep) | Unique() | Transform(square) | Take(count);
+			passed &= Expect(ToVector(pipeline) == expected && ToVector(pipeline) == expected, "View pipeline", iteration);
+			ListNode<int>* materialized = ToList(pipeline);
+			passed &= Expect(ListNodeChecks::ToVector(materialized) == expected, "View ToList", iteration);
+			ListNodeHelper::FreeList(materialized);
+
+			if (!values.empty())
+			{
+				passed &= Expect(*std::max_element(All(list).begin(), All(list).end()) == *std::max_element(values.begin(), values.end()), "View max_element", iteration);
 			}
+			passed &= Expect(ListNodeChecks::ToVector(list) == values, "View leaves the list untouched", iteration);
+			ListNodeHelper::FreeList(list);
 		}
+		std::cout << "ListNodeView checks: " << (passed ? "passed" : "FAILED") << std::endl;
+		return passed;
+	}
 
-		ListNode<T> dummy; 
-		ListNode<T>* tail = &dummy;
+	// Ordered by key alone, so a stable algorithm is told from an unstable one by the ids of equal keys.
+	struct KeyedValue
+	{
+		int key = 0;
+		int id = 0;
 
-		while (!minHeap.empty())
+		bool operator<(const KeyedValue& other) const
 		{
-			ListNode<T>* smallest = minHeap.top();
-			minHeap.pop();
+			return key < other.key;
+		}
 
-			tail->pNext = smallest;
-			tail = tail->pNext;
+		bool operator>(const KeyedValue& other) const
+		{
+			return other < *this;
+		}
 
-			if (smallest->pNext != nullptr)
-			{ 
-				minHeap.push(smallest->pNext);
-			}
+		bool operator==(const KeyedValue& other) const
+		{
+			return key == other.key && id == other.id;
 		}
-		
-		return dummy.pNext;
-	}
+	};
 
-	// Leet Code 148 - Sort a linked list into ascending order
-	template <typename T>
-	ListNode<T>* Sort(ListNode<T>* head)
+	std::vector<KeyedValue> RandomKeyedValues(int maxSize, int maxKey)
 	{
-		if (!head || !head->pNext)
+		std::vector<KeyedValue> values(rand() % (maxSize + 1));
+		for (std::size_t i = 0; i < values.size(); ++i)
 		{
-			return head;
+			values[i] = { rand() % (maxKey + 1), static_cast<int>(i) };
 		}
+		return values;
+	}
 
-		ListNode<T>* slow = head;
-		ListNode<T>* fast = head;
-		ListNode<T>* previous = nullptr;
-
-		while (fast && fast->pNext)
+	ListNode<KeyedValue>* MakeKeyedList(const std::vector<KeyedValue>& values)
+	{
+		ListNode<KeyedValue> dummy;
+		ListNode<KeyedValue>* tail = &dummy;
+		for (const KeyedValue& value : values)
 		{
-			previous = slow;
-			slow = slow->pNext;
-			fast = fast->pNext->pNext;
+			tail->pNext = new ListNode<KeyedValue>(value);
+			tail = tail->pNext;
 		}
+		return dummy.pNext;
+	}
 
-		if (previous)
+	// A small threshold and a pool of its own, so the runs are split and merged on several threads
+	// whatever the core count.
+	bool CheckSorts(int iterations = 500)
+	{
+		srand(148);
+		ListTaskPool pool(3);
+		bool passed = true;
+		for (int iteration = 0; iteration < iterations && passed; ++iteration)
 		{
-			previous->pNext = nullptr;
+			std::vector<KeyedValue> values = RandomKeyedValues(600, 20);
+			std::vector<KeyedValue> expected = values;
+			std::stable_sort(expected.begin(), expected.end());
+
+			ListNode<KeyedValue>* bottomUp = ListNodeHelper::SortBottomUp(MakeKeyedList(values));
+			ListNode<KeyedValue>* natural = ListNodeHelper::SortBottomUp(MakeKeyedList(values), true);
+			ListNode<KeyedValue>* parallel = ListNodeHelper::ParallelSort(MakeKeyedList(values), pool, 16);
+			passed &= Expect(ToVector(bottomUp) == expected, "SortBottomUp stable", iteration);
+			passed &= Expect(ToVector(natural) == expected, "SortBottomUp natural runs stable", iteration);
+			passed &= Expect(ToVector(parallel) == ToVector(bottomUp), "ParallelSort matches SortBottomUp", iteration);
+			ListNodeHelper::FreeList(bottomUp);
+			ListNodeHelper::FreeList(natural);
+			ListNodeHelper::FreeList(parallel);
 		}
-
-		ListNode<T>* left = Sort(head);
-		ListNode<T>* right = Sort(slow);
-
-		return Merge(left, right);
+		std::cout << "Sort checks: " << (passed ? "passed" : "FAILED") << std::endl;
+		return passed;
 	}
 
-	// Leet Code 328 - Odd even linked list
-	template <typename T>
-	ListNode<T>* OddEvenSort(ListNode<T>* head)
+	std::vector<int> Keys(const std::vector<KeyedValue>& values)
 	{
-		ListNode<T> dummyOdd;
-		ListNode<T>* tailOdd = &dummyOdd;
-
-		ListNode<T> dummyEven;
-		ListNode<T>* tailEven = &dummyEven;
+		std::vector<int> keys;
+		for (const KeyedValue& value : values)
+		{
+			keys.push_back(value.key);
+		}
+		return keys;
+	}
 
-		bool isOddTurn = true;
-		while (head != nullptr)
+	// Ids number the values in list order, so a stable k-way merge gives what std::stable_sort gives
+	// on the lists laid end to end. The priority_queue Merge makes no promise on ties; only its keys are compared.
+	bool CheckMerges(int iterations = 500)
+	{
+		srand(23);
+		ListTaskPool pool(3);
+		bool passed = true;
+		for (int iteration = 0; iteration < iterations && passed; ++iteration)
 		{
-			if (isOddTurn)
-			{
-				// here we add odd node to the tail, then we move this node to the next
-				tailOdd->pNext = head;
-				tailOdd = tailOdd->pNext;
-			}
-			else
+			std::vector<std::vector<KeyedValue>> inputs(rand() % 41);
+			std::vector<KeyedValue> expected;
+			for (auto& input : inputs)
 			{
-				tailEven->pNext = head;
-				tailEven = tailEven->pNext;
+				input = RandomKeyedValues(rand() % 4 == 0 ? 0 : 30, 15);
+				std::stable_sort(input.begin(), input.end());
+				for (KeyedValue& value : input)
+				{
+					value.id = static_cast<int>(expected.size());
+					expected.push_back(value);
+				}
 			}
+			std::stable_sort(expected.begin(), expected.end());
 
-			head = head->pNext;
-			isOddTurn = !isOddTurn;
+			auto makeLists = [&inputs]
+				{
+					std::vector<ListNode<KeyedValue>*> lists;
+					for (const auto& input : inputs)
+					{
+						lists.push_back(MakeKeyedList(input));
+					}
+					return lists;
+				};
+			std::vector<ListNode<KeyedValue>*> heapInput = makeLists();
+			ListNode<KeyedValue>* heap = ListNodeHelper::Merge(heapInput);
+			ListNode<KeyedValue>* tournament = ListNodeHelper::MergeTournament(makeLists());
+			ListNode<KeyedValue>* parallel = ListNodeHelper::ParallelMerge(makeLists(), pool, 2);
+			passed &= Expect(Keys(ToVector(heap)) == Keys(expected), "Merge (priority_queue) keys", iteration);
+			passed &= Expect(ToVector(tournament) == expected, "MergeTournament stable", iteration);
+			passed &= Expect(ToVector(parallel) == expected, "ParallelMerge stable", iteration);
+			passed &= Expect(Keys(ToVector(tournament)) == Keys(ToVector(heap)), "MergeTournament matches Merge", iteration);
+			ListNodeHelper::FreeList(heap);
+			ListNodeHelper::FreeList(tournament);
+			ListNodeHelper::FreeList(parallel);
 		}
+		std::cout << "Merge checks: " << (passed ? "passed" : "FAILED") << std::endl;
+		return passed;
+	}
+}
 
-		tailEven->pNext = nullptr;
+namespace ListNodeBenchmark
+{
+	// The layout ListNode had before values were stored inline: one allocation for the node, one for the value.
+	struct BoxedNode
+	{
+		BoxedNode* pNext = nullptr;
+		int* pValue = nullptr;
+	};
 
-		// head is now pointing to the odd list last node
-		tailOdd->pNext = dummyEven.pNext;
-		return dummyOdd.pNext;
+	template <typename Function>
+	double MeasureMilliseconds(Function function)
+	{
+		auto start = std::chrono::steady_clock::now();
+		function();
+		auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+		return static_cast<double>(elapsed.count()) / 1000.0;
 	}
 
-	// Leet Code 725
-	template <typename T>
-	std::vector<ListNode<T>*> SplitByKParts(ListNode<T>* head, int k)
+	template <typename Node, typename Read>
+	long long Sum(const Node* head, Read read)
 	{
-		// Size and length calculation.
-		int size = 0;
-		for (auto current = head; current != nullptr; current = current->pNext)
+		long long sum = 0;
+		for (; head != nullptr; head = head->pNext)
 		{
-			++size;
+			sum += read(head);
 		}
+		return sum;
+	}
 
-		int baseLen = size / k;
-		int extra = size % k;
-
-		// Init result vector
-		std::vector<ListNode<T>*> result(k, nullptr);
-
-		// Processing parts
-		ListNode<T>* current = head;
-		for (int i = 0; i < k && current != nullptr; ++i)
+	void RunAllocation(int count = 1000000)
+	{
+		std::vector<int> values(count);
+		for (int i = 0; i < count; ++i)
 		{
-			int partSize = baseLen + (i < extra ? 1 : 0);
+			values[i] = i;
+		}
 
-			result[i] = current;
-			for (int j = 1; j < partSize; ++j)
+		long long checksum = 0;
+		std::cout << "build / traverse / free " << count << " nodes (ms)" << std::endl;
+
+		BoxedNode* boxed = nullptr;
+		double buildMs = MeasureMilliseconds([&]
 			{
-				if (current != nullptr)
+				BoxedNode dummy;
+				BoxedNode* tail = &dummy;
+				for (int value : values)
 				{
-					current = current->pNext;
+					tail->pNext = new BoxedNode{ nullptr, new int(value) };
+					tail = tail->pNext;
 				}
-			}
-
-			// Moving to next part
-			if (current != nullptr)
+				boxed = dummy.pNext;
+			});
+		double traverseMs = MeasureMilliseconds([&] { checksum += Sum(boxed, [](const BoxedNode* node) { return *node->pValue; }); });
+		double freeMs = MeasureMilliseconds([&]
 			{
-				ListNode<T>* nextPart = current->pNext;
-				current->pNext = nullptr;
-				current = nextPart;
-			}
+				while (boxed != nullptr)
+				{
+					BoxedNode* next = boxed->pNext;
+					delete boxed->pValue;
+					delete boxed;
+					boxed = next;
+				}
+			});
+		std::cout << "boxed value, global heap  " << buildMs << " / " << traverseMs << " / " << freeMs << std::endl;
+
+		ListNode<int>* list = nullptr;
+		buildMs = MeasureMilliseconds([&] { list = ListNodeCreator::MakeNumericList(values); });
+		traverseMs = MeasureMilliseconds([&] { checksum += Sum(list, [](const ListNode<int>* node) { return node->value; }); });
+		freeMs = MeasureMilliseconds([&] { ListNodeHelper::FreeList(list); });
+		std::cout << "inline value, global heap " << buildMs << " / " << traverseMs << " / " << freeMs << std::endl;
+
+		ListNodePool<int> pool;
+		{
+			ListNodePool<int>::Scope scope(pool);
+			buildMs = MeasureMilliseconds([&] { list = ListNodeCreator::MakeNumericList(values); });
+			traverseMs = MeasureMilliseconds([&] { checksum += Sum(list, [](const ListNode<int>* node) { return node->value; }); });
+			freeMs = MeasureMilliseconds([&] { ListNodeHelper::FreeList(list); });
 		}
-		return result;
-	}
+		std::cout << "inline value, FreeList    " << buildMs << " / " << traverseMs << " / " << freeMs << std::endl;
 
-	// Leet Code 61 - Rotate List to the Right
-	template <typename T>
-	ListNode<T>* RotateRight(ListNode<T>* head, int k)
-	{
-		if (head == nullptr || head->pNext == nullptr || k == 0)
 		{
-			return head;
+			ListNodePool<int>::Scope scope(pool);
+			buildMs = MeasureMilliseconds([&] { list = ListNodeCreator::MakeNumericList(values); });
+			traverseMs = MeasureMilliseconds([&] { checksum += Sum(list, [](const ListNode<int>* node) { return node->value; }); });
+			freeMs = MeasureMilliseconds([&] { pool.Release(); });
 		}
+		std::cout << "inline value, Release     " << buildMs << " / " << traverseMs << " / " << freeMs << std::endl;
+		std::cout << "(checksum " << checksum << ")" << std::endl;
+	}
 
-		// Get the length of the list
-		int n = 1;
-		ListNode<T>* tail = head;
-		while (tail->pNext != nullptr)
+	void RunUnrolled(int count = 1000000)
+	{
+		std::vector<int> values(count);
+		srand(42);
+		for (int& value : values)
 		{
-			tail = tail->pNext;
-			++n;
+			value = rand() % 1000;
 		}
 
-		// Resolve k 
-		k %= n;
-		if (k < 0) k += n; // Convert to rotate right if negative
-		if (k == 0) return head;
+		ListNode<int>* list = ListNodeCreator::MakeNumericList(values);
+		UnrolledListNode<int>* unrolled = UnrolledListHelper::FromList(list);
+		long long checksum = 0;
+
+		std::cout << "size / remove / sort / unique on " << count << " values (ms)" << std::endl;
+		double sizeMs = MeasureMilliseconds([&] { checksum += ListNodeHelper::Size(list); });
+		double removeMs = MeasureMilliseconds([&] { list = ListNodeHelper::RemoveElement(list, 7); });
+		double sortMs = MeasureMilliseconds([&] { list = ListNodeHelper::Sort(list); });
+		double uniqueMs = MeasureMilliseconds([&] { list = ListNodeHelper::MakeUnique(list); });
+		checksum += ListNodeHelper::Size(list);
+		std::cout << "ListNode          " << sizeMs << " / " << removeMs << " / " << sortMs << " / " << uniqueMs << std::endl;
+
+		sizeMs = MeasureMilliseconds([&] { checksum += UnrolledListHelper::Size(unrolled); });
+		removeMs = MeasureMilliseconds([&] { unrolled = UnrolledListHelper::RemoveElement(unrolled, 7); });
+		sortMs = MeasureMilliseconds([&] { unrolled = UnrolledListHelper::Sort(unrolled); });
+		uniqueMs = MeasureMilliseconds([&] { unrolled = UnrolledListHelper::MakeUnique(unrolled); });
+		checksum += UnrolledListHelper::Size(unrolled);
+		std::cout << "UnrolledListNode  " << sizeMs << " / " << removeMs << " / " << sortMs << " / " << uniqueMs << std::endl;
+		std::cout << "(checksum " << checksum << ")" << std::endl;
 
-		// Create loop
-		tail->pNext = head;
+		ListNodeHelper::FreeList(list);
+		UnrolledListHelper::FreeList(unrolled);
+	}
 
-		// Find new tail
-		int stepsToNewTail = n - k - 1;
-		ListNode<T>* newTail = head;
-		for (int i = 0; i < stepsToNewTail; ++i)
+	bool RunParallelSort(int count = 2000000)
+	{
+		std::vector<int> values(count);
+		srand(42);
+		for (int& value : values)
 		{
-			newTail = newTail->pNext;
+			value = rand();
 		}
 
-		ListNode<T>* newHead = newTail->pNext;
-		newTail->pNext = nullptr;
+		// A fresh pool and both lists built up front, so neither list is laid out in freed nodes.
+		ListNodePool<int> pool;
+		ListNodePool<int>::Scope scope(pool);
+		ListNode<int>* list = ListNodeCreator::MakeNumericList(values);
+		ListNode<int>* other = ListNodeCreator::MakeNumericList(values);
+		double sequentialMs = MeasureMilliseconds([&] { list = ListNodeHelper::Sort(list); });
+		double parallelMs = MeasureMilliseconds([&] { other = ListNodeHelper::ParallelSort(other); });
+
+		std::sort(values.begin(), values.end());
+		bool passed = ListNodeChecks::Expect(ListNodeChecks::ToVector(list) == values, "Sort result", 0);
+		passed &= ListNodeChecks::Expect(ListNodeChecks::ToVector(other) == values, "ParallelSort result", 0);
+		ListNodeHelper::FreeList(list);
+		ListNodeHelper::FreeList(other);
 
-		return newHead;
+		std::cout << "sort " << count << " values on " << ListTaskPool::Shared().GetConcurrency() << " threads (ms)" << std::endl;
+		std::cout << "Sort          " << sequentialMs << std::endl;
+		std::cout << "ParallelSort  " << parallelMs << std::endl;
+		return passed;
 	}
 
-	// Leet Code 206 - Reverse a linked list
-	template <typename T>
-	ListNode<T>* Reverse(ListNode<T>* head)
+	bool RunKWayMerge(int k = 2000, int lengthEach = 500)
 	{
-		ListNode<T> dummy;
-		while (head != nullptr)
+		srand(42);
+		ListNodePool<int> pool;
+		ListNodePool<int>::Scope scope(pool);
+
+		// Every merge gets the same values, so the three results can be compared.
+		std::vector<std::vector<int>> inputs(k, std::vector<int>(lengthEach));
+		for (auto& values : inputs)
 		{
-			ListNode<T>* tmp = head->pNext;
-			head->pNext = dummy.pNext;
-			dummy.pNext = head;
-			head = tmp;
+			for (int& value : values)
+			{
+				value = rand() % 1000000;
+			}
+			std::sort(values.begin(), values.end());
 		}
-		return dummy.pNext;
 
-		// Note:
-		// Taking list 4->3->2 as example
-		// h = 4
-		// (4)->[(3)]...			>>> (4)->[(nil)]
-		// (d)->[(nil)]				>>> (d)->[(4)->(nil)]  
-		// h = 3
-		// (3)->[(2)]...			>>> (3)->[(4)->(nil)]
-	    // (d)->[(4)->(nil)]		>>> (d)->[(3)->(4)->(nil)]
-		// h = 2
-		// (2)->[(nil)]				>>> (2)->[(3)->(4)->(nil)]
-	    // (d)->[(3)->(4)->(nil)]	>>> (d)->[(2)->(3)->(4)->(nil)]
+		auto makeLists = [&]
+			{
+				std::vector<ListNode<int>*> lists(k);
+				for (int i = 0; i < k; ++i)
+				{
+					lists[i] = ListNodeCreator::MakeNumericList(inputs[i]);
+				}
+				return lists;
+			};
+
+		std::vector<ListNode<int>*> heapInput = makeLists();
+		std::vector<ListNode<int>*> tournamentInput = makeLists();
+		std::vector<ListNode<int>*> parallelInput = makeLists();
+		ListNode<int>* heapResult = nullptr;
+		ListNode<int>* tournamentResult = nullptr;
+		ListNode<int>* parallelResult = nullptr;
+
+		std::cout << "merge " << k << " lists of " << lengthEach << " values (ms)" << std::endl;
+		std::cout << "Merge (priority_queue)  " << MeasureMilliseconds([&] { heapResult = ListNodeHelper::Merge(heapInput); }) << std::endl;
+		std::cout << "MergeTournament         " << MeasureMilliseconds([&] { tournamentResult = ListNodeHelper::MergeTournament(tournamentInput); }) << std::endl;
+		std::cout << "ParallelMerge           " << MeasureMilliseconds([&] { parallelResult = ListNodeHelper::ParallelMerge(parallelInput); }) << std::endl;
+
+		std::vector<int> expected = ListNodeChecks::ToVector(heapResult);
+		bool passed = ListNodeChecks::Expect(std::is_sorted(expected.begin(), expected.end()) && expected.size() == static_cast<std::size_t>(k) * lengthEach, "Merge (priority_queue) result", 0);
+		passed &= ListNodeChecks::Expect(ListNodeChecks::ToVector(tournamentResult) == expected, "MergeTournament result", 0);
+		passed &= ListNodeChecks::Expect(ListNodeChecks::ToVector(parallelResult) == expected, "ParallelMerge result", 0);
+		ListNodeHelper::FreeList(heapResult);
+		ListNodeHelper::FreeList(tournamentResult);
+		ListNodeHelper::FreeList(parallelResult);
+		return passed;
 	}
 
-	// Leet Code 25 - Reverse nodes in k-group
-	template <typename T>
-	ListNode<T>* Reverse(ListNode<T>* head, int k)
+	struct SequencedItem
 	{
-		if (head == nullptr || k == 1)
+		int producer = 0;
+		int sequence = 0;
+	};
+
+	// Producers push numbered items concurrently; the consumer checks that nothing is lost or
+	// duplicated and that each producer's items arrive in the order they were pushed.
+	bool RunMpscStress(int producerCount = 4, int itemsPerProducer = 250000)
+	{
+		std::vector<std::vector<MpscNode<SequencedItem>>> items(producerCount);
+		for (auto& producerItems : items)
 		{
-			return head;
+			producerItems = std::vector<MpscNode<SequencedItem>>(itemsPerProducer);
 		}
+		MpscQueue<MpscNode<SequencedItem>> queue;
+		std::atomic<bool> go{ false };
+		std::vector<std::thread> producers;
 
-		ListNode<T> dummy;
-		dummy.pNext = head;
-		ListNode<T>* previousGroupTail = &dummy;
-
-		while (true)
+		for (int p = 0; p < producerCount; ++p)
 		{
-			// find k-th
-			ListNode<T>* kTh = previousGroupTail;
-			for (int i = 0; i < k && kTh != nullptr; ++i)
-			{
-				kTh = kTh->pNext;
-			}
+			producers.emplace_back([&, p]
+				{
+					while (!go.load(std::memory_order_acquire))
+					{
+						std::this_thread::yield();
+					}
+					for (int i = 0; i < itemsPerProducer; ++i)
+					{
+						items[p][i].value = { p, i };
+						queue.Push(&items[p][i]);
+					}
+				});
+		}
 
-			if (kTh == nullptr)
-			{
-				break;
-			}
-			
-			// track group heads
-			ListNode<T>* groupHead = previousGroupTail->pNext;
-			ListNode<T>* nextGroupHead = kTh->pNext;
+		std::vector<int> expected(producerCount, 0);
+		long long received = 0;
+		long long total = static_cast<long long>(producerCount) * itemsPerProducer;
+		bool ordered = true;
 
-			// reverse group
-			ListNode<T>* previous = nextGroupHead;
-			ListNode<T>* current = groupHead;
-			while (current != nextGroupHead)
+		go.store(true, std::memory_order_release);
+		while (received < total)
+		{
+			std::size_t popped = queue.PopBatch([&](MpscNode<SequencedItem>* item)
+				{
+					ordered = ordered && item->value.sequence == expected[item->value.producer]++;
+				}, 256);
+
+			received += static_cast<long long>(popped);
+			if (popped == 0)
 			{
-				ListNode<T>* tmp = current->pNext;
-				current->pNext = previous;
-				previous = current;
-				current = tmp;
+				std::this_thread::yield();
 			}
+		}
 
-			previousGroupTail->pNext = kTh;
-			previousGroupTail = groupHead;
-
+		for (auto& producer : producers)
+		{
+			producer.join();
 		}
-		return dummy.pNext;
+
+		bool passed = ordered && queue.Pop() == nullptr;
+		std::cout << "MpscQueue stress, " << producerCount << " producers x " << itemsPerProducer << " items: " << (passed ? "passed" : "FAILED") << std::endl;
+		return passed;
 	}
-}
 
-namespace ListNodeCreator
-{
-	ListNode<int>* MakeNumericListLooped(int maxNumber)
+	// Mutex-protected std::deque as the baseline; the consumer swaps out everything queued at once.
+	class LockedDequeQueue
 	{
-		ListNode<int>* head = new ListNode<int>(1);
-		ListNode<int>* current = head;
-		ListNode<int>* loop = head;
-
-		srand(time(NULL));
-		int selection = rand() % (maxNumber + 1);
-		std::cout << "Loop index picked at : " << (selection - 1 < 0 ? 0 : (selection - 1 > maxNumber ? maxNumber : selection - 1)) << std::endl;
-
-		for (int i = 0; i < maxNumber - 1; ++i)
+	public:
+		void Push(MpscNode<SequencedItem>* item)
 		{
-			current->pNext = new ListNode<int>(i + 2);
-			current = current->pNext;
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Items.push_back(item);
+		}
 
-			if (i + 2 == selection)
+		template <typename Function>
+		std::size_t PopBatch(Function consume, std::size_t)
+		{
 			{
-				loop = current;
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				m_Batch.swap(m_Items);
+			}
+			std::size_t count = m_Batch.size();
+			for (auto* item : m_Batch)
+			{
+				consume(item);
 			}
+			m_Batch.clear();
+			return count;
 		}
-		current->pNext = loop;
-		return head;
-	}
 
-	ListNode<int>* MakeNumericList(std::vector<int>& intList)
+	private:
+		std::mutex m_Mutex;
+		std::deque<MpscNode<SequencedItem>*> m_Items;
+		std::deque<MpscNode<SequencedItem>*> m_Batch;
+	};
+
+	// Nanoseconds per item from the first push until the consumer has seen every item.
+	template <typename Queue>
+	double MeasureHandoff(int producerCount, int itemsPerProducer)
 	{
-		if (intList.empty())
+		std::vector<std::vector<MpscNode<SequencedItem>>> items(producerCount);
+		for (auto& producerItems : items)
 		{
-			return nullptr;
+			producerItems = std::vector<MpscNode<SequencedItem>>(itemsPerProducer);
 		}
+		Queue queue;
+		std::atomic<int> ready{ 0 };
+		std::atomic<bool> go{ false };
+		std::vector<std::thread> producers;
 
-		ListNode<int>* head = new ListNode<int>(intList[0]);
-		ListNode<int>* current = head;
-		for (int i = 1; i < intList.size(); ++i)
+		for (int p = 0; p < producerCount; ++p)
 		{
-			ListNode<int>* pNode = new ListNode<int>(intList[i]);
-			current->pNext = pNode;
-			current = current->pNext;
+			producers.emplace_back([&, p]
+				{
+					ready.fetch_add(1);
+					while (!go.load(std::memory_order_acquire))
+					{
+						std::this_thread::yield();
+					}
+					for (auto& item : items[p])
+					{
+						queue.Push(&item);
+					}
+				});
 		}
-		return head;
-	}
 
-	ListNode<int>* MakeNumericList(std::initializer_list<int> intList)
-	{
-		if (intList.size() == 0)
+		while (ready.load() != producerCount)
 		{
-			return nullptr;
+			std::this_thread::yield();
 		}
 
-		auto it = intList.begin();
-		ListNode<int>* head = new ListNode<int>(*it);
-		ListNode<int>* current = head;
-		++it;
+		long long total = static_cast<long long>(producerCount) * itemsPerProducer;
+		long long received = 0;
+		long long checksum = 0;
+		auto start = std::chrono::steady_clock::now();
+		go.store(true, std::memory_order_release);
+		while (received < total)
+		{
+			std::size_t popped = queue.PopBatch([&](MpscNode<SequencedItem>* item) { checksum += item->value.sequence; }, 1024);
+			received += static_cast<long long>(popped);
+			if (popped == 0)
+			{
+				std::this_thread::yield();
+			}
+		}
+		auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
 
-		for (; it != intList.end(); ++it)
+		for (auto& producer : producers)
 		{
-			ListNode<int>* pNode = new ListNode<int>(*it);
-			current->pNext = pNode;
-			current = current->pNext;
+			producer.join();
 		}
-		return head;
+		return static_cast<double>(elapsed.count()) / static_cast<double>(total);
 	}
-}
 
-namespace ListNodeTester
-{
-	// Extends if test function returns more possible types.
-	template <typename T>
-	using TestResult = std::variant<ListNode<T>*, std::vector<ListNode<T>*>, bool, std::optional<int>>;
-
-	template <typename T>
-	static void MakeTest(const char* testName, const std::function<TestResult<T>()>& testFunction)
+	void RunMpscThroughput(int itemsPerProducer = 500000)
 	{
-		TestResult<T> result = testFunction();
-		std::cout << testName << " (Solution) : ";
+		std::cout << "producers  MpscQueue(ns/item)  mutex+deque(ns/item)" << std::endl;
+		for (int producerCount : { 1, 2, 4, 8 })
+		{
+			double lockFreeNs = MeasureHandoff<MpscQueue<MpscNode<SequencedItem>>>(producerCount, itemsPerProducer);
+			double lockedNs = MeasureHandoff<LockedDequeQueue>(producerCount, itemsPerProducer);
+			std::cout << producerCount << "  " << lockFreeNs << "  " << lockedNs << std::endl;
+		}
+	}
 
-		std::visit([&](auto&& value)
-			{
-				using U = std::decay_t<decltype(value)>;
-				if constexpr (std::is_same_v<U, ListNode<T>*>)
-				{
-					ListNodeHelper::Print(value);
-					ListNodeHelper::FreeList(value);
-				}
-				else if constexpr (std::is_same_v<U, std::vector<ListNode<T>*>>)
-				{
-					std::cout << "[" << std::endl;
-					for (auto part : value)
-					{
-						ListNodeHelper::Print(part);
-						ListNodeHelper::FreeList(part);
-					}
-					std::cout << "]" << std::endl;
-				}
-				else if constexpr (std::is_same_v<U, bool>)
-				{
-					std::cout << (value ? "true" : "false") << std::endl;
+	void RunBottomUpSort(int count = 1000000)
+	{
+		std::vector<int> random(count);
+		srand(42);
+		for (int& value : random)
+		{
+			value = rand();
+		}
 
-					// WARNING : FREED THE LIST IN THE LAMBDA
-				}
-				else if constexpr (std::is_same_v<U, std::optional<int>>)
-				{
-					if (value)
-					{
-						std::cout << *value << std::endl;
-					}
-					else
-					{
-						std::cout << "nullopt" << std::endl;
-					}
+		// Sorted, then about one element in a hundred swapped with a random partner.
+		std::vector<int> nearlySorted(random);
+		std::sort(nearlySorted.begin(), nearlySorted.end());
+		for (int i = 0; i < count / 100; ++i)
+		{
+			std::swap(nearlySorted[rand() % count], nearlySorted[rand() % count]);
+		}
 
-					// WARNING : FREED THE LIST IN THE LAMBDA
-				}
+		std::cout << "sort " << count << " values, random / nearly sorted (ms)" << std::endl;
+		auto measure = [](std::vector<int>& values, auto sort)
+			{
+				ListNodePool<int> pool;
+				ListNodePool<int>::Scope scope(pool);
+				ListNode<int>* list = ListNodeCreator::MakeNumericList(values);
+				double ms = MeasureMilliseconds([&] { list = sort(list); });
+				ListNodeHelper::FreeList(list);
+				return ms;
+			};
 
-			}, result);
+		auto topDown = [](ListNode<int>* list) { return ListNodeHelper::Sort(list); };
+		auto bottomUp = [](ListNode<int>* list) { return ListNodeHelper::SortBottomUp(list); };
+		auto natural = [](ListNode<int>* list) { return ListNodeHelper::SortBottomUp(list, true); };
+		std::cout << "Sort                      " << measure(random, topDown) << " / " << measure(nearlySorted, topDown) << std::endl;
+		std::cout << "SortBottomUp              " << measure(random, bottomUp) << " / " << measure(nearlySorted, bottomUp) << std::endl;
+		std::cout << "SortBottomUp natural runs " << measure(random, natural) << " / " << measure(nearlySorted, natural) << std::endl;
 	}
 }
 
-int main()
+int main(int argc, char* argv[])
 {
+	if (argc > 1 && std::string(argv[1]) == "--bench")
+	{
+		ListNodeBenchmark::RunAllocation();
+		ListNodeBenchmark::RunUnrolled();
+		ListNodeBenchmark::RunBottomUpSort();
+		bool passed = ListNodeBenchmark::RunParallelSort();
+		passed = ListNodeBenchmark::RunKWayMerge() && passed;
+		ListNodeBenchmark::RunMpscThroughput();
+		return passed ? 0 : 1;
+	}
+	if (argc > 1 && std::string(argv[1]) == "--stress")
+	{
+		return ListNodeBenchmark::RunMpscStress() ? 0 : 1;
+	}
+	if (argc > 1 && std::string(argv[1]) == "--check")
+	{
+		bool passed = ListNodeChecks::CheckUnrolled();
+		passed = ListNodeChecks::CheckList() && passed;
+		passed = ListNodeChecks::CheckViews() && passed;
+		passed = ListNodeChecks::CheckSorts() && passed;
+		passed = ListNodeChecks::CheckMerges() && passed;
+		return passed ? 0 : 1;
+	}
+
 #if 0
 	ListNodeTester::MakeTest<int>("No19a", [] {
 		auto list = ListNodeCreator::MakeNumericList({ 1, 2, 3, 4, 5, 6, 7, 8 });
@@ -1004,6 +3832,61 @@ int main()
 		});
 #endif 
 
+	ListNodeTester::MakeTest<int>("Unrolled", [] {
+		auto list = ListNodeCreator::MakeNumericList({ 5, 1, 4, 1, 3, 9, 2, 6, 5, 3, 5, 8, 9, 7, 9, 3, 2, 3, 8, 4, 6, 2, 6, 4, 3, 3, 8, 3, 2, 7, 9, 5 });
+		auto unrolled = UnrolledListHelper::FromList(list);
+		ListNodeHelper::FreeList(list);
+		UnrolledListHelper::Print("Unrolled", unrolled);
+		unrolled = UnrolledListHelper::RemoveElement(unrolled, 3);
+		unrolled = UnrolledListHelper::MakeUnique(UnrolledListHelper::Sort(unrolled));
+		unrolled = UnrolledListHelper::RotateRight(UnrolledListHelper::Reverse(unrolled), 2);
+		UnrolledListHelper::Print("Unrolled", unrolled);
+		auto result = UnrolledListHelper::ToList(unrolled);
+		UnrolledListHelper::FreeList(unrolled);
+		return ListNodeTester::TestResult<int>(result);
+		});
+
+	ListNodeTester::MakeTest<int>("List", [] {
+		List<int> list = { 4, 2, 2, 7, 1, 3 };
+		list.PushBack(5);
+		list.PushFront(6);
+		list.Print("List");
+		list.Sort();
+		list.MakeUnique();
+		list.RotateRight(2);
+		list.RemoveNthElementFromEnd(1);
+		list.PushBack(list.GetSize());
+		std::vector<List<int>> parts = list.SplitByKParts(3);
+		for (auto& part : parts)
+		{
+			part.Print("List part");
+		}
+		parts[0].Append(std::move(parts[2]));
+		return ListNodeTester::TestResult<int>(parts[0].Release());
+		});
+
+	ListNodeTester::MakeTest<int>("View", [] {
+		auto list = ListNodeCreator::MakeNumericList({ 1, 1, 2, 6, 3, 3, 6, 4, 5, 5, 6, 7, 8, 8, 9 });
+		ListNodeHelper::Print("View", list);
+
+		// Remove 6, drop repeats and split into pairs in one walk, leaving the list untouched.
+		using namespace ListNodeView;
+		for (const auto& chunk : All(list) | Filter([](int value) { return value != 6; }) | Unique() | Chunk(2))
+		{
+			std::cout << "View chunk:";
+			for (int value : chunk)
+			{
+				std::cout << " " << value;
+			}
+			std::cout << std::endl;
+		}
+
+		std::cout << "View max: " << *std::max_element(All(list).begin(), All(list).end()) << std::endl;
+		auto squares = ToList(All(list) | Unique() | Transform([](int value) { return value * value; }) | Take(5));
+		ListNodeHelper::FreeList(list);
+		return ListNodeTester::TestResult<int>(squares);
+		});
+
 	system("pause");
 	return 0;
 }
\ No newline at end of file
@@ -1,115 +1,2447 @@
 #include <string>
 #include <iostream>
+#include <atomic>
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <memory>
+#include <map>
+#include <mutex>
+#include <new>
+#include <sstream>
+#include <thread>
+#include <type_traits>
+#include <typeinfo>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#if defined(__GNUG__)
+#include <cxxabi.h>
+#endif
+
+// Test-and-test-and-set lock for very short critical sections, usable with std::lock_guard.
+class SpinLock
+{
+public:
+    void lock()
+    {
+        while (m_Locked.exchange(true, std::memory_order_acquire))
+        {
+            while (m_Locked.load(std::memory_order_relaxed))
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    void unlock()
+    {
+        m_Locked.store(false, std::memory_order_release);
+    }
+
+private:
+    std::atomic<bool> m_Locked{ false };
+};
+
+// Recycles fixed-size blocks through an intrusive free list. Blocks are carved from large
+// chunks, which go back to the system allocator only when the pool itself is destroyed.
+class FixedBlockPool
+{
+public:
+    FixedBlockPool(std::size_t blockSize, std::size_t blockAlign, std::size_t blocksPerChunk = 256)
+        : m_BlockAlign(std::max(blockAlign, alignof(FreeBlock))), m_BlocksPerChunk(blocksPerChunk)
+    {
+        std::size_t size = std::max(blockSize, sizeof(FreeBlock));
+        m_BlockSize = (size + m_BlockAlign - 1) / m_BlockAlign * m_BlockAlign;
+    }
+
+    ~FixedBlockPool()
+    {
+        for (void* chunk : m_Chunks)
+        {
+            ::operator delete(chunk, std::align_val_t(m_BlockAlign));
+        }
+    }
+
+    FixedBlockPool(const FixedBlockPool&) = delete;
+    FixedBlockPool& operator=(const FixedBlockPool&) = delete;
+
+    void* Allocate()
+    {
+        std::lock_guard<SpinLock> lock(m_Lock);
+        if (m_FreeList == nullptr)
+        {
+            Grow();
+        }
+        FreeBlock* block = m_FreeList;
+        m_FreeList = block->pNext;
+        return block;
+    }
+
+    void Deallocate(void* ptr)
+    {
+        std::lock_guard<SpinLock> lock(m_Lock);
+        FreeBlock* block = static_cast<FreeBlock*>(ptr);
+        block->pNext = m_FreeList;
+        m_FreeList = block;
+    }
+
+    std::size_t GetBlockSize() const { return m_BlockSize; }
+
+private:
+    struct FreeBlock
+    {
+        FreeBlock* pNext;
+    };
+
+    // Caller must hold m_Lock.
+    void Grow()
+    {
+        char* chunk = static_cast<char*>(::operator new(m_BlockSize * m_BlocksPerChunk, std::align_val_t(m_BlockAlign)));
+        m_Chunks.push_back(chunk);
+        for (std::size_t i = m_BlocksPerChunk; i > 0; --i)
+        {
+            FreeBlock* block = reinterpret_cast<FreeBlock*>(chunk + (i - 1) * m_BlockSize);
+            block->pNext = m_FreeList;
+            m_FreeList = block;
+        }
+    }
+
+    std::size_t m_BlockSize;
+    std::size_t m_BlockAlign;
+    std::size_t m_BlocksPerChunk;
+    SpinLock m_Lock;
+    FreeBlock* m_FreeList = nullptr;
+    std::vector<void*> m_Chunks;
+};
+
+// Mixin that routes new/delete of T through a per-type FixedBlockPool, so released
+// objects are recycled instead of going back to the system allocator.
+template <typename T>
+class MyPoolAllocated
+{
+public:
+    static void* operator new(std::size_t size)
+    {
+        // A derived class that is larger than T falls back to the global allocator
+        return size == sizeof(T) ? GetPool().Allocate() : ::operator new(size);
+    }
+
+    static void operator delete(void* ptr, std::size_t size)
+    {
+        if (size == sizeof(T))
+        {
+            GetPool().Deallocate(ptr);
+        }
+        else
+        {
+            ::operator delete(ptr);
+        }
+    }
+
+    // Never destroyed, objects may still be released by other static destructors at exit.
+    static FixedBlockPool& GetPool()
+    {
+        static FixedBlockPool* pool = new FixedBlockPool(sizeof(T), alignof(T));
+        return *pool;
+    }
+};
+
+// One pool per block size and alignment, shared by every type with that layout.
+// Never destroyed, for the same reason as MyPoolAllocated::GetPool.
+template <std::size_t Size, std::size_t Align>
+FixedBlockPool& GetSizedPool()
+{
+    static FixedBlockPool* pool = new FixedBlockPool(Size, Align);
+    return *pool;
+}
+
+// Standard allocator interface over GetSizedPool. Single objects, such as control blocks,
+// are recycled through the pool, arrays go to the global allocator.
+template <typename T>
+class MyPoolAllocator
+{
+public:
+    using value_type = T;
+
+    MyPoolAllocator() noexcept {}
+
+    template <typename U>
+    MyPoolAllocator(const MyPoolAllocator<U>&) noexcept {}
+
+    T* allocate(std::size_t count)
+    {
+        if (count == 1)
+        {
+            return static_cast<T*>(GetSizedPool<sizeof(T), alignof(T)>().Allocate());
+        }
+        return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t(alignof(T))));
+    }
+
+    void deallocate(T* ptr, std::size_t count)
+    {
+        if (count == 1)
+        {
+            GetSizedPool<sizeof(T), alignof(T)>().Deallocate(ptr);
+            return;
+        }
+        ::operator delete(ptr, std::align_val_t(alignof(T)));
+    }
+};
+
+// Stateless, any instance can free what another allocated.
+template <typename T, typename U>
+bool operator==(const MyPoolAllocator<T>&, const MyPoolAllocator<U>&)
+{
+    return true;
+}
+
+template <typename T, typename U>
+bool operator!=(const MyPoolAllocator<T>&, const MyPoolAllocator<U>&)
+{
+    return false;
+}
+
+// Counting policies for MySharedPtr. Each provides Increase, Decrease (true when the last
+// strong reference is gone), IncreaseIfNotZero and GetCount, and starts at one reference.
+
+// Plain count for pointers that never leave the thread that created them.
+class NonAtomicCount
+{
+public:
+    void Increase()
+    {
+        ++m_Count;
+    }
+
+    bool Decrease()
+    {
+        return --m_Count == 0;
+    }
+
+    bool IncreaseIfNotZero()
+    {
+        if (m_Count == 0)
+        {
+            return false;
+        }
+        ++m_Count;
+        return true;
+    }
+
+    int GetCount() const
+    {
+        return m_Count;
+    }
+
+private:
+    int m_Count = 1;
+};
+
+// Default policy, any thread may copy or release.
+class AtomicCount
+{
+public:
+    // The caller already owns a reference, so the object cannot die concurrently
+    // and the increment only needs to be atomic, not ordered.
+    void Increase()
+    {
+        m_Count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Every owner publishes its writes with release, the last one acquires them all
+    // before the object is deleted, same as std::shared_ptr.
+    bool Decrease()
+    {
+        if (m_Count.fetch_sub(1, std::memory_order_release) == 1)
+        {
+            std::atomic_thread_fence(std::memory_order_acquire);
+            return true;
+        }
+        return false;
+    }
+
+    // For MyWeakPtr::lock, which holds no strong reference and must not revive a dead object.
+    bool IncreaseIfNotZero()
+    {
+        int count = m_Count.load(std::memory_order_relaxed);
+        while (count != 0)
+        {
+            if (m_Count.compare_exchange_weak(count, count + 1, std::memory_order_acq_rel, std::memory_order_relaxed))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    int GetCount() const
+    {
+        return m_Count.load(std::memory_order_relaxed);
+    }
+
+    // Takes several references at once for a caller that already owns one, see MyAtomicSharedPtr.
+    void Add(int count)
+    {
+        m_Count.fetch_add(count, std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<int> m_Count{ 1 };
+};
+
+class BiasedCount;
+
+// Blocks whose shared count went negative on another thread, waiting for their owner
+// to fold in its biased count. One per thread, freed once the thread has exited and
+// no block points at it anymore.
+struct BiasedMergeQueue
+{
+    std::atomic<BiasedCount*> m_Head{ nullptr };
+    std::atomic<bool> m_IsOrphaned{ false }; // Owner thread has exited
+    std::atomic<int> m_References{ 1 };      // Owned blocks, plus one for the live thread
+
+    void AddReference()
+    {
+        m_References.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void Release()
+    {
+        if (m_References.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            delete this;
+        }
+    }
+};
+
+// Biased reference counting: the thread that created the object counts its own copies in a
+// plain integer, every other thread uses the atomic shared count. The shared count may go
+// negative when the owner hands a reference to another thread that then drops it, so only
+// the sum is meaningful. Once the owner's biased count reaches zero it merges into the
+// shared count (MERGED) and from then on the shared count alone decides. If the shared count
+// goes negative before that, the block is queued (QUEUED) for the owner to merge, since only
+// the owner can read the biased count.
+class BiasedCount
+{
+public:
+    BiasedCount() : m_OwnerQueue(GetThreadQueue())
+    {
+        m_OwnerQueue->AddReference();
+    }
+
+    void Increase()
+    {
+        if (IsOwner())
+        {
+            ++m_Biased;
+            return;
+        }
+        m_Shared.fetch_add(ONE, std::memory_order_relaxed);
+    }
+
+    bool Decrease()
+    {
+        if (IsOwner())
+        {
+            bool isLast = false;
+            if (--m_Biased == 0)
+            {
+                // Implicit merge, a queued block is released by the queue instead.
+                int64_t merged = Merge(0);
+                isLast = (merged & QUEUED) == 0 && Count(merged) == 0;
+            }
+
+            // Not before the decrement, the queue may hold this block and merge it.
+            if (m_OwnerQueue->m_Head.load(std::memory_order_relaxed) != nullptr)
+            {
+                ProcessQueue(m_OwnerQueue);
+            }
+            return isLast;
+        }
+
+        int64_t old = m_Shared.load(std::memory_order_relaxed);
+        int64_t desired;
+        do
+        {
+            desired = old - ONE;
+            if ((old & (MERGED | QUEUED)) == 0 && Count(desired) < 0)
+            {
+                desired |= QUEUED;
+            }
+        } while (!m_Shared.compare_exchange_weak(old, desired, std::memory_order_acq_rel, std::memory_order_relaxed));
+
+        if ((old & QUEUED) == 0 && (desired & QUEUED) != 0)
+        {
+            Enqueue();
+            return false;
+        }
+        return (desired & (MERGED | QUEUED)) == MERGED && Count(desired) == 0;
+    }
+
+    // Before the merge the owner still holds a biased reference, so the object is alive.
+    bool IncreaseIfNotZero()
+    {
+        if (IsOwner())
+        {
+            ++m_Biased;
+            return true;
+        }
+
+        int64_t old = m_Shared.load(std::memory_order_relaxed);
+        do
+        {
+            if ((old & MERGED) != 0 && Count(old) <= 0)
+            {
+                return false;
+            }
+        } while (!m_Shared.compare_exchange_weak(old, old + ONE, std::memory_order_acq_rel, std::memory_order_relaxed));
+        return true;
+    }
+
+    // Exact on the owner thread or after the merge, other threads only know it is alive.
+    int GetCount() const
+    {
+        int64_t shared = m_Shared.load(std::memory_order_relaxed);
+        if (IsOwner())
+        {
+            return static_cast<int>(m_Biased + Count(shared));
+        }
+        if ((shared & MERGED) == 0)
+        {
+            return static_cast<int>(std::max<int64_t>(1, Count(shared)));
+        }
+        return static_cast<int>(std::max<int64_t>(0, Count(shared)));
+    }
+
+    // Merges the blocks other threads queued for the calling thread. Also done on the owner's
+    // releases and at thread exit, long-lived owners that rarely release can call it from their loop.
+    static void ProcessMergeQueue()
+    {
+        ProcessQueue(GetThreadQueue());
+    }
+
+protected:
+    ~BiasedCount()
+    {
+        m_OwnerQueue->Release();
+    }
+
+    // Implemented by the control block, called when a queued merge finds the count at zero.
+    virtual void ReleaseObject() = 0;
+
+private:
+    // The low two bits of m_Shared are flags, the count is stored above them.
+    static constexpr int64_t MERGED = 1;
+    static constexpr int64_t QUEUED = 2;
+    static constexpr int64_t ONE = 4;
+
+    static int64_t Count(int64_t shared)
+    {
+        return shared >> 2;
+    }
+
+    // Compares queues instead of thread ids, ids are reused but a queue outlives its blocks.
+    // After the owner exits its blocks are merged by whoever queues them, so it stops being special.
+    bool IsOwner() const
+    {
+        return m_OwnerQueue == t_Queue && !m_OwnerMerged && !m_OwnerQueue->m_IsOrphaned.load(std::memory_order_relaxed);
+    }
+
+    // Folds the biased count into the shared count, returns the new shared word.
+    int64_t Merge(int64_t biased)
+    {
+        int64_t old = m_Shared.load(std::memory_order_relaxed);
+        int64_t desired;
+        do
+        {
+            desired = (old + biased * ONE) | MERGED;
+        } while (!m_Shared.compare_exchange_weak(old, desired, std::memory_order_acq_rel, std::memory_order_relaxed));
+
+        m_OwnerMerged = true;
+        m_Biased = 0;
+        return desired;
+    }
+
+    // Merge requested through the queue. Clears QUEUED so later releases decide on their own.
+    void ExplicitMerge()
+    {
+        int64_t old = m_Shared.load(std::memory_order_relaxed);
+        int64_t biased = m_OwnerMerged ? 0 : m_Biased;
+        int64_t desired;
+        do
+        {
+            desired = ((old + biased * ONE) | MERGED) & ~QUEUED;
+        } while (!m_Shared.compare_exchange_weak(old, desired, std::memory_order_acq_rel, std::memory_order_relaxed));
+
+        m_OwnerMerged = true;
+        m_Biased = 0;
+        if (Count(desired) == 0)
+        {
+            ReleaseObject();
+        }
+    }
+
+    // seq_cst against the owner's exit, which marks the queue orphaned before draining it:
+    // either the owner sees this block or this thread sees the flag and merges it here.
+    void Enqueue()
+    {
+        // Once pushed, this block may be merged and freed at any time, and the queue with it.
+        BiasedMergeQueue* queue = m_OwnerQueue;
+        queue->AddReference();
+        BiasedCount* head = queue->m_Head.load(std::memory_order_relaxed);
+        do
+        {
+            m_NextQueued = head;
+        } while (!queue->m_Head.compare_exchange_weak(head, this, std::memory_order_seq_cst, std::memory_order_relaxed));
+
+        if (queue->m_IsOrphaned.load(std::memory_order_seq_cst))
+        {
+            ProcessQueue(queue);
+        }
+        queue->Release();
+    }
+
+    static void ProcessQueue(BiasedMergeQueue* queue)
+    {
+        BiasedCount* block = queue->m_Head.exchange(nullptr, std::memory_order_seq_cst);
+        while (block != nullptr)
+        {
+            BiasedCount* next = block->m_NextQueued; // The merge may free the block
+            block->ExplicitMerge();
+            block = next;
+        }
+    }
+
+    static BiasedMergeQueue* GetThreadQueue()
+    {
+        struct ExitGuard
+        {
+            ~ExitGuard()
+            {
+                t_Queue->m_IsOrphaned.store(true, std::memory_order_seq_cst);
+                ProcessQueue(t_Queue);
+                t_Queue->Release();
+                t_Queue = nullptr;
+            }
+        };
+        thread_local ExitGuard guard;
+        if (t_Queue == nullptr)
+        {
+            t_Queue = new BiasedMergeQueue();
+        }
+        (void)guard;
+        return t_Queue;
+    }
+
+    static thread_local BiasedMergeQueue* t_Queue;
+
+    BiasedMergeQueue* m_OwnerQueue;
+    int64_t m_Biased = 1;        // Owner thread only
+    bool m_OwnerMerged = false;  // Owner thread only
+    std::atomic<int64_t> m_Shared{ 0 };
+    BiasedCount* m_NextQueued = nullptr;
+};
+
+thread_local BiasedMergeQueue* BiasedCount::t_Queue = nullptr;
+
+// Epoch-based deferred reclamation. Objects whose last reference is gone are collected in a
+// per-thread retire list and handed over in batches to a background thread, which releases
+// a batch once the global epoch has advanced twice since it was retired. Threads that read
+// through raw pointers without holding a reference enter an EpochReclaimer::Guard, which
+// holds the epoch back until they leave, so nothing they can still see is released.
+class EpochReclaimer
+{
+    struct ThreadState;
+
+public:
+    using ReleaseFunction = void (*)(void*);
+
+    // Never destroyed, retired objects may still arrive from static destructors at exit.
+    static EpochReclaimer& Get()
+    {
+        static EpochReclaimer* reclaimer = new EpochReclaimer();
+        return *reclaimer;
+    }
+
+    // Pins the current epoch for the calling thread. Guards nest, only the outermost one counts.
+    class Guard
+    {
+    public:
+        Guard() : m_State(GetThreadState())
+        {
+            if (m_State.m_GuardDepth++ == 0)
+            {
+                m_State.m_Record->m_ActiveEpoch.store(Get().m_Epoch.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+            }
+        }
+
+        ~Guard()
+        {
+            if (--m_State.m_GuardDepth == 0)
+            {
+                m_State.m_Record->m_ActiveEpoch.store(INACTIVE, std::memory_order_release);
+            }
+        }
+
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+
+    private:
+        ThreadState& m_State;
+    };
+
+    // Queues release(object) on the calling thread, nothing is released inline.
+    void Retire(void* object, ReleaseFunction release)
+    {
+        ThreadState& state = GetThreadState();
+        state.m_Pending.push_back(Retired{ object, release });
+        if (state.m_Pending.size() >= BATCH_SIZE)
+        {
+            Flush(state);
+        }
+    }
+
+    // Hands the calling thread's partial batch to the reclaimer, e.g. before going idle.
+    void Flush()
+    {
+        Flush(GetThreadState());
+    }
+
+    // Blocks until everything retired so far, by this thread or flushed by others, is released.
+    // Must not be called inside a Guard, the epoch could never advance.
+    void Synchronize()
+    {
+        Flush();
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        uint64_t target = m_SubmittedBatches;
+        m_SyncWaiters++;
+        m_Wakeup.notify_one();
+        m_Released.wait(lock, [&] { return m_ReleasedBatches >= target; });
+        m_SyncWaiters--;
+    }
+
+    uint64_t GetEpoch() const
+    {
+        return m_Epoch.load(std::memory_order_relaxed);
+    }
+
+private:
+    static constexpr uint64_t INACTIVE = 0;
+    static constexpr std::size_t BATCH_SIZE = 64;
+
+    struct Retired
+    {
+        void* m_Object;
+        ReleaseFunction m_Release;
+    };
+
+    struct Batch
+    {
+        uint64_t m_Epoch;
+        std::vector<Retired> m_Items;
+    };
+
+    // One per live thread, reused after the thread exits.
+    struct ThreadRecord
+    {
+        std::atomic<uint64_t> m_ActiveEpoch{ INACTIVE };
+        bool m_InUse = true; // Guarded by m_RecordsMutex
+    };
+
+    struct ThreadState
+    {
+        ThreadRecord* m_Record;
+        int m_GuardDepth = 0;
+        std::vector<Retired> m_Pending;
+
+        ThreadState() : m_Record(Get().AcquireRecord()) {}
+
+        ~ThreadState()
+        {
+            Get().Flush(*this);
+            Get().ReleaseRecord(m_Record);
+        }
+    };
+
+    friend class Guard;
+
+    EpochReclaimer()
+    {
+        // Detached, it lives as long as the process like the reclaimer itself.
+        std::thread([this] { Run(); }).detach();
+    }
+
+    static ThreadState& GetThreadState()
+    {
+        thread_local ThreadState state;
+        return state;
+    }
+
+    ThreadRecord* AcquireRecord()
+    {
+        std::lock_guard<std::mutex> lock(m_RecordsMutex);
+        for (ThreadRecord* record : m_Records)
+        {
+            if (!record->m_InUse)
+            {
+                record->m_InUse = true;
+                return record;
+            }
+        }
+        m_Records.push_back(new ThreadRecord());
+        return m_Records.back();
+    }
+
+    void ReleaseRecord(ThreadRecord* record)
+    {
+        std::lock_guard<std::mutex> lock(m_RecordsMutex);
+        record->m_ActiveEpoch.store(INACTIVE, std::memory_order_relaxed);
+        record->m_InUse = false;
+    }
+
+    void Flush(ThreadState& state)
+    {
+        if (state.m_Pending.empty())
+        {
+            return;
+        }
+
+        Batch batch{ m_Epoch.load(std::memory_order_seq_cst), std::move(state.m_Pending) };
+        state.m_Pending.clear();
+        state.m_Pending.reserve(BATCH_SIZE);
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Incoming.push_back(std::move(batch));
+            m_SubmittedBatches++;
+        }
+        m_Wakeup.notify_one();
+    }
+
+    // Only this thread advances the epoch: once every thread inside a Guard has seen the current one.
+    bool TryAdvanceEpoch()
+    {
+        uint64_t epoch = m_Epoch.load(std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> lock(m_RecordsMutex);
+            for (ThreadRecord* record : m_Records)
+            {
+                uint64_t active = record->m_ActiveEpoch.load(std::memory_order_seq_cst);
+                if (active != INACTIVE && active != epoch)
+                {
+                    return false;
+                }
+            }
+        }
+        m_Epoch.store(epoch + 1, std::memory_order_seq_cst);
+        return true;
+    }
+
+    void Run()
+    {
+        std::deque<Batch> waiting; // In retirement order, so epochs only grow towards the back
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        for (;;)
+        {
+            m_Wakeup.wait_for(lock, std::chrono::milliseconds(waiting.empty() ? 100 : 1), [&]
+                {
+                    return !m_Incoming.empty() || (m_SyncWaiters > 0 && !waiting.empty());
+                });
+            for (Batch& batch : m_Incoming)
+            {
+                waiting.push_back(std::move(batch));
+            }
+            m_Incoming.clear();
+            lock.unlock();
+
+            uint64_t released = 0;
+            if (!waiting.empty())
+            {
+                TryAdvanceEpoch();
+                uint64_t epoch = m_Epoch.load(std::memory_order_seq_cst);
+                while (!waiting.empty() && waiting.front().m_Epoch + 2 <= epoch)
+                {
+                    for (const Retired& retired : waiting.front().m_Items)
+                    {
+                        retired.m_Release(retired.m_Object);
+                    }
+                    waiting.pop_front();
+                    released++;
+                }
+                // Releases here may retire more objects, they must not wait for another batch to fill.
+                Flush();
+            }
+
+            lock.lock();
+            if (released > 0)
+            {
+                m_ReleasedBatches += released;
+                m_Released.notify_all();
+            }
+        }
+    }
+
+    std::atomic<uint64_t> m_Epoch{ 1 }; // Starts above INACTIVE
+
+    std::mutex m_Mutex;
+    std::condition_variable m_Wakeup;
+    std::condition_variable m_Released;
+    std::vector<Batch> m_Incoming;
+    uint64_t m_SubmittedBatches = 0;
+    uint64_t m_ReleasedBatches = 0;
+    int m_SyncWaiters = 0;
+
+    std::mutex m_RecordsMutex;
+    std::vector<ThreadRecord*> m_Records;
+};
+
+// Count policy wrapper that moves the release of zero-count objects off the calling thread:
+// the object is retired to the EpochReclaimer and destroyed there in a batch.
+// Weak references see it expired immediately.
+template <typename CountPolicy = AtomicCount>
+class DeferredReclaim : public CountPolicy
+{
+};
+
+template <typename CountPolicy>
+struct IsDeferredReclaim : std::false_type
+{
+};
+
+template <typename CountPolicy>
+struct IsDeferredReclaim<DeferredReclaim<CountPolicy>> : std::true_type
+{
+};
+
+// Ownership tracing, off by default. Build with -DMYSHAREDPTR_TRACING=1 to record a sample of
+// live control blocks with where they were created, the managed type and the highest strong
+// count seen, and get a summary from MyTraceRegistry::Dump or at exit.
+#ifndef MYSHAREDPTR_TRACING
+#define MYSHAREDPTR_TRACING 0
+#endif
+
+// One block in this many is traced, per creating thread.
+#ifndef MYSHAREDPTR_TRACE_SAMPLE
+#define MYSHAREDPTR_TRACE_SAMPLE 64
+#endif
+
+// Creation sites come from GCC/Clang builtins, so they only appear in traced builds and the
+// untraced signatures stay portable. The factories are kept out of line while tracing, so their
+// return address names the caller; the constructors take defaulted file and line arguments.
+#if MYSHAREDPTR_TRACING
+#define MYSHAREDPTR_TRACE_NOINLINE __attribute__((noinline))
+#define MYSHAREDPTR_TRACE_CALLER __builtin_return_address(0)
+#define MYSHAREDPTR_TRACE_SITE_PARAMS , const char* file = __builtin_FILE(), int line = __builtin_LINE()
+#define MYSHAREDPTR_TRACE_SITE_ARGS , file, line
+#else
+#define MYSHAREDPTR_TRACE_NOINLINE
+#define MYSHAREDPTR_TRACE_CALLER nullptr
+#define MYSHAREDPTR_TRACE_SITE_PARAMS
+#define MYSHAREDPTR_TRACE_SITE_ARGS
+#endif
+
+// Where a block was created. Constructors record file and line, the variadic factories cannot
+// take defaulted location arguments and record their return address instead, for addr2line
+// (minus the load address in position independent executables).
+struct MyTraceSite
+{
+    const char* m_File;
+    int m_Line;
+    const void* m_ReturnAddress;
+};
+
+struct MyTraceRecord
+{
+    const std::type_info* m_Type;
+    MyTraceSite m_Site;
+    std::chrono::steady_clock::time_point m_Created;
+    std::atomic<int> m_PeakCount{ 1 };
+
+    void NoteCount(int count)
+    {
+        int peak = m_PeakCount.load(std::memory_order_relaxed);
+        while (count > peak && !m_PeakCount.compare_exchange_weak(peak, count, std::memory_order_relaxed))
+        {
+        }
+    }
+};
+
+class MyTraceRegistry
+{
+public:
+    // Never destroyed, blocks may still be released by other static destructors at exit.
+    static MyTraceRegistry& Get()
+    {
+        static MyTraceRegistry* registry = new MyTraceRegistry();
+        return *registry;
+    }
+
+    // Counter only, the unsampled blocks never touch the registry.
+    static bool ShouldSample()
+    {
+        thread_local unsigned int created = 0;
+        return created++ % MYSHAREDPTR_TRACE_SAMPLE == 0;
+    }
+
+    MyTraceRecord* Register(const std::type_info& type, const MyTraceSite& site)
+    {
+        MyTraceRecord* record = new MyTraceRecord();
+        record->m_Type = &type;
+        record->m_Site = site;
+        record->m_Created = std::chrono::steady_clock::now();
+
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (!m_IsExitDumpRegistered)
+        {
+            m_IsExitDumpRegistered = true;
+            std::atexit([] { Get().Dump(std::cerr); });
+        }
+        m_Live.insert(record);
+        return record;
+    }
+
+    void Unregister(MyTraceRecord* record)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Live.erase(record);
+        }
+        delete record;
+    }
+
+    // Live blocks grouped by site and type, the largest groups first. Counts are scaled
+    // back up by the sampling rate, so they are estimates.
+    void Dump(std::ostream& out = std::cout) const
+    {
+        if (!MYSHAREDPTR_TRACING)
+        {
+            out << "MySharedPtr tracing is disabled, build with -DMYSHAREDPTR_TRACING=1" << std::endl;
+            return;
+        }
+
+        struct Group
+        {
+            std::string m_Site;
+            std::string m_Type;
+            std::size_t m_Live = 0;
+            int m_PeakCount = 0;
+            double m_OldestSeconds = 0.0;
+        };
+
+        std::map<std::pair<std::string, std::string>, Group> groups;
+        auto now = std::chrono::steady_clock::now();
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            for (const MyTraceRecord* record : m_Live)
+            {
+                std::ostringstream site;
+                if (record->m_Site.m_File != nullptr)
+                {
+                    site << record->m_Site.m_File << ":" << record->m_Site.m_Line;
+                }
+                else
+                {
+                    site << "caller " << record->m_Site.m_ReturnAddress;
+                }
+
+                Group& group = groups[{ site.str(), record->m_Type->name() }];
+                group.m_Site = site.str();
+                group.m_Type = record->m_Type->name();
+                group.m_Live++;
+                group.m_PeakCount = std::max(group.m_PeakCount, record->m_PeakCount.load(std::memory_order_relaxed));
+                group.m_OldestSeconds = std::max(group.m_OldestSeconds, std::chrono::duration<double>(now - record->m_Created).count());
+            }
+        }
+
+        std::vector<Group> sorted;
+        for (auto& entry : groups)
+        {
+            sorted.push_back(entry.second);
+        }
+        std::sort(sorted.begin(), sorted.end(), [](const Group& lhs, const Group& rhs) { return lhs.m_Live > rhs.m_Live; });
+
+        out << "live MySharedPtr blocks (sampled 1/" << MYSHAREDPTR_TRACE_SAMPLE << ")" << std::endl;
+        out << "estimated  peak  oldest(s)  type  site" << std::endl;
+        for (const Group& group : sorted)
+        {
+            out << group.m_Live * MYSHAREDPTR_TRACE_SAMPLE << "  " << group.m_PeakCount << "  " << group.m_OldestSeconds
+                << "  " << Demangle(group.m_Type.c_str()) << "  " << group.m_Site << std::endl;
+        }
+    }
+
+private:
+    static std::string Demangle(const char* name)
+    {
+#if defined(__GNUG__)
+        int status = 0;
+        char* demangled = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+        if (status == 0 && demangled != nullptr)
+        {
+            std::string result(demangled);
+            std::free(demangled);
+            return result;
+        }
+#endif
+        return name;
+    }
+
+    mutable std::mutex m_Mutex;
+    std::unordered_set<MyTraceRecord*> m_Live;
+    bool m_IsExitDumpRegistered = false;
+};
 
 // Do not initialize m_Count to 1 on creation because of MySharedPtr<T> usage. 
 // This will wrongfully set the counter to 1 when no actual instance is created.
-class Counter
+// The strong count comes from CountPolicy, a block only exists once there is an instance to count.
+template <typename CountPolicy>
+class Counter : public CountPolicy
+{
+public:
+    Counter() {}
+    virtual ~Counter()
+    {
+#if MYSHAREDPTR_TRACING
+        if (m_Trace != nullptr)
+        {
+            MyTraceRegistry::Get().Unregister(m_Trace);
+        }
+#endif
+    }
+
+    // Hide the policy's versions to feed the traced peak count, plain forwards without tracing.
+    void Increase()
+    {
+        CountPolicy::Increase();
+        NoteCount();
+    }
+
+    bool IncreaseIfNotZero()
+    {
+        if (!CountPolicy::IncreaseIfNotZero())
+        {
+            return false;
+        }
+        NoteCount();
+        return true;
+    }
+
+    // Called once by whoever created the block, registers it if it falls in the sample.
+    void Trace(const std::type_info& type, const MyTraceSite& site)
+    {
+#if MYSHAREDPTR_TRACING
+        if (MyTraceRegistry::ShouldSample())
+        {
+            m_Trace = MyTraceRegistry::Get().Register(type, site);
+        }
+#else
+        (void)type;
+        (void)site;
+#endif
+    }
+
+    void IncreaseWeak()
+    {
+        m_WeakCount.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Frees the block once the last weak reference is gone.
+    void ReleaseWeak()
+    {
+        if (m_WeakCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            DestroyBlock();
+        }
+    }
+
+    int GetWeakCount()
+    {
+        // Do not report the reference held on behalf of the strong owners
+        return m_WeakCount.load(std::memory_order_relaxed) - (this->GetCount() > 0 ? 1 : 0);
+    }
+
+    // Called by the owner that dropped the strong count to zero.
+    void ReleaseObject()
+    {
+        if constexpr (IsDeferredReclaim<CountPolicy>::value)
+        {
+            EpochReclaimer::Get().Retire(this, &Counter::ReleaseRetired);
+        }
+        else
+        {
+            DisposeObject();
+            ReleaseWeak();
+        }
+    }
+
+    // The object this block manages, for holders that only keep the block pointer.
+    virtual void* GetManagedObject() = 0;
+
+protected:
+    static void ReleaseRetired(void* block)
+    {
+        Counter* counter = static_cast<Counter*>(block);
+        counter->DisposeObject();
+        counter->ReleaseWeak();
+    }
+
+    // Destroys the managed object, each block type knows where its object lives.
+    virtual void DisposeObject() = 0;
+    // Frees the block itself, only once no weak reference can still read the counts.
+    virtual void DestroyBlock() = 0;
+
+private:
+    void NoteCount()
+    {
+#if MYSHAREDPTR_TRACING
+        if (m_Trace != nullptr)
+        {
+            m_Trace->NoteCount(this->GetCount());
+        }
+#endif
+    }
+
+    // Weak references are rare, so this one stays atomic under every policy.
+    std::atomic<int> m_WeakCount{ 1 }; // Weak references, plus one shared by all strong owners
+#if MYSHAREDPTR_TRACING
+    MyTraceRecord* m_Trace = nullptr;
+#endif
+};
+
+// Allocates and constructs a control block with Alloc rebound to the block type.
+template <typename Block, typename Alloc, typename... Args>
+Block* CreateBlock(const Alloc& alloc, Args&&... args)
+{
+    using BlockAllocator = typename std::allocator_traits<Alloc>::template rebind_alloc<Block>;
+    using Traits = std::allocator_traits<BlockAllocator>;
+
+    BlockAllocator allocator(alloc);
+    Block* block = Traits::allocate(allocator, 1);
+    try
+    {
+        Traits::construct(allocator, block, std::forward<Args>(args)...);
+    }
+    catch (...)
+    {
+        Traits::deallocate(allocator, block, 1);
+        throw;
+    }
+    return block;
+}
+
+// Counterpart of CreateBlock. alloc usually lives inside the block, so it is copied first.
+template <typename Block, typename Alloc>
+void DestroyBlockWith(const Alloc& alloc, Block* block)
+{
+    using BlockAllocator = typename std::allocator_traits<Alloc>::template rebind_alloc<Block>;
+    using Traits = std::allocator_traits<BlockAllocator>;
+
+    BlockAllocator allocator(alloc);
+    Traits::destroy(allocator, block);
+    Traits::deallocate(allocator, block, 1);
+}
+
+// Block for an object allocated separately by the caller, as in MySharedPtr<T>(new T()).
+// Deleter releases the object, Alloc provided the block and gets it back. Allocators are
+// a private base so the usual empty ones take no space.
+template <typename T, typename Deleter, typename Alloc, typename CountPolicy>
+class PointerCounter : public Counter<CountPolicy>, private Alloc
+{
+public:
+    PointerCounter(T* ptr, const Deleter& deleter, const Alloc& alloc) : Alloc(alloc), m_Ptr(ptr), m_Deleter(deleter) {}
+
+    void* GetManagedObject() override
+    {
+        return m_Ptr;
+    }
+
+protected:
+    void DisposeObject() override
+    {
+        m_Deleter(m_Ptr);
+    }
+
+    void DestroyBlock() override
+    {
+        DestroyBlockWith(static_cast<const Alloc&>(*this), this);
+    }
+
+private:
+    T* m_Ptr;
+    Deleter m_Deleter;
+};
+
+// Block with the object stored right after the count, created by MakeMyShared.
+// One allocation instead of two, and count updates touch the object's cache line.
+// The object is destroyed with the last strong reference, but its storage is only
+// returned together with the block once weak references are gone too.
+template <typename T, typename Alloc, typename CountPolicy>
+class InplaceCounter : public Counter<CountPolicy>, private Alloc
+{
+public:
+    template <typename... Args>
+    explicit InplaceCounter(const Alloc& alloc, Args&&... args) : Alloc(alloc)
+    {
+        new (&m_Storage) T(std::forward<Args>(args)...);
+    }
+
+    T* GetObject()
+    {
+        return std::launder(reinterpret_cast<T*>(&m_Storage));
+    }
+
+    void* GetManagedObject() override
+    {
+        return GetObject();
+    }
+
+protected:
+    void DisposeObject() override
+    {
+        GetObject()->~T();
+    }
+
+    void DestroyBlock() override
+    {
+        DestroyBlockWith(static_cast<const Alloc&>(*this), this);
+    }
+
+private:
+    alignas(T) unsigned char m_Storage[sizeof(T)];
+};
+
+template <typename T, typename CountPolicy = AtomicCount>
+class MySharedPtr;
+
+template <typename T, typename CountPolicy = AtomicCount>
+class MyWeakPtr;
+
+template <typename T, typename CountPolicy = AtomicCount, typename... Args>
+MySharedPtr<T, CountPolicy> MakeMyShared(Args&&... args);
+
+template <typename T, typename CountPolicy = AtomicCount, typename Alloc, typename... Args>
+MySharedPtr<T, CountPolicy> AllocateMyShared(const Alloc& alloc, Args&&... args);
+
+template <typename T>
+class MyAtomicSharedPtr;
+
+// CountPolicy picks the synchronization each call site pays for: NonAtomicCount for pointers
+// confined to one thread, AtomicCount (default) for free sharing, BiasedCount when the creating
+// thread does most of the copying but others still hold references.
+// MySharedPtr<T[]> owns an array: it releases with delete[] and offers operator[] instead of -> and *.
+template <typename T, typename CountPolicy> 
+class MySharedPtr
+{
+public:
+    using element_type = std::remove_extent_t<T>;
+
+    MySharedPtr() : m_Ptr(nullptr), m_Counter(nullptr) {} // Default initializers
+    explicit MySharedPtr(element_type* ptr MYSHAREDPTR_TRACE_SITE_PARAMS)
+        : MySharedPtr(ptr, std::default_delete<T>(), std::allocator<element_type>() MYSHAREDPTR_TRACE_SITE_ARGS) {} // Explicitly initializer
+
+    // For objects that did not come from new: deleter(ptr) runs with the last strong reference,
+    // e.g. to hand the object back to its arena. The control block comes from alloc, the global
+    // heap by default; pass MyPoolAllocator to recycle blocks through a pool instead.
+    // If the block cannot be allocated, ptr is released before rethrowing.
+    // When tracing, file and line are the caller's, kept by the registry.
+    template <typename Deleter, typename Alloc = std::allocator<element_type>>
+    MySharedPtr(element_type* ptr, Deleter deleter, const Alloc& alloc = Alloc() MYSHAREDPTR_TRACE_SITE_PARAMS)
+        : m_Ptr(ptr), m_Counter(nullptr)
+    {
+        try
+        {
+            m_Counter = CreateBlock<PointerCounter<element_type, Deleter, Alloc, CountPolicy>>(alloc, ptr, deleter, alloc);
+        }
+        catch (...)
+        {
+            deleter(ptr);
+            throw;
+        }
+#if MYSHAREDPTR_TRACING
+        m_Counter->Trace(typeid(T), MyTraceSite{ file, line, nullptr });
+#endif
+    }
+
+    // Aliasing: shares owner's block, so owner's object lives as long as this pointer, but points
+    // at ptr, typically a member or a slice of it. Nothing is copied.
+    template <typename U>
+    MySharedPtr(const MySharedPtr<U, CountPolicy>& owner, element_type* ptr) : m_Ptr(ptr), m_Counter(owner.m_Counter)
+    {
+        if (m_Counter != nullptr)
+        {
+            m_Counter->Increase();
+        }
+    }
+
+    template <typename U>
+    MySharedPtr(MySharedPtr<U, CountPolicy>&& owner, element_type* ptr) noexcept : m_Ptr(ptr), m_Counter(owner.m_Counter)
+    {
+        owner.m_Ptr = nullptr;
+        owner.m_Counter = nullptr;
+    }
+    ~MySharedPtr()
+    {
+        Release();
+    }
+
+    // This is a sp(otherSharedPtr) call, creating a new reference
+    MySharedPtr(const MySharedPtr<T, CountPolicy>& other)
+    {
+        // This is shallow copy and it is intended
+        m_Ptr = other.m_Ptr;
+        m_Counter = other.m_Counter;
+
+        if (m_Counter != nullptr)
+        {
+            m_Counter->Increase();
+        }
+    }
+
+    // This is a copy constructor
+    const MySharedPtr<T, CountPolicy>& operator=(const MySharedPtr<T, CountPolicy>& other)
+    {
+        // Aliases of one owner share the block but not the pointer, so only the count is skipped.
+        if (m_Counter != other.m_Counter)
+        {
+            // Take the new reference before dropping the old one, the old one may be what keeps other alive
+            if (other.m_Counter != nullptr)
+            {
+                other.m_Counter->Increase();
+            }
+            Release();
+
+            m_Counter = other.m_Counter;
+        }
+        m_Ptr = other.m_Ptr;
+
+        return *this;
+    }
+
+    // Steals the reference, the count is untouched. noexcept so std::vector moves instead of copies on growth.
+    MySharedPtr(MySharedPtr<T, CountPolicy>&& other) noexcept : m_Ptr(other.m_Ptr), m_Counter(other.m_Counter)
+    {
+        other.m_Ptr = nullptr;
+        other.m_Counter = nullptr;
+    }
+
+    MySharedPtr<T, CountPolicy>& operator=(MySharedPtr<T, CountPolicy>&& other) noexcept
+    {
+        if (this != &other)
+        {
+            Release();
+
+            m_Ptr = other.m_Ptr;
+            m_Counter = other.m_Counter;
+            other.m_Ptr = nullptr;
+            other.m_Counter = nullptr;
+        }
+
+        return *this;
+    }
+
+    void swap(MySharedPtr<T, CountPolicy>& other) noexcept
+    {
+        std::swap(m_Ptr, other.m_Ptr);
+        std::swap(m_Counter, other.m_Counter);
+    }
+
+    void reset() noexcept
+    {
+        Release();
+    }
+
+    void reset(element_type* ptr)
+    {
+        MySharedPtr<T, CountPolicy>(ptr).swap(*this);
+    }
+
+    element_type* get()
+    {
+        return m_Ptr;
+    }
+
+    template <typename U = T, typename = std::enable_if_t<!std::is_array<U>::value>>
+    U* operator->() 
+    {
+        return m_Ptr;
+    }
+
+    template <typename U = T, typename = std::enable_if_t<!std::is_array<U>::value>>
+    U& operator*() 
+    {
+        return *m_Ptr;
+    }
+
+    template <typename U = T, typename = std::enable_if_t<std::is_array<U>::value>>
+    element_type& operator[](std::ptrdiff_t index)
+    {
+        return m_Ptr[index];
+    }
+
+    int GetCount()
+    {
+        // When MySharedPtr<T> is called, accessing the counter is 0. It is technically not shared yet.
+        return m_Counter != nullptr ? m_Counter->GetCount() : 0;
+    }
+
+private:
+    template <typename U, typename P, typename A, typename... Args>
+    friend MySharedPtr<U, P> AllocateMySharedFor(const void* caller, const A& alloc, Args&&... args);
+    friend class MyWeakPtr<T, CountPolicy>;
+    friend class MyAtomicSharedPtr<T>;
+    template <typename U, typename P>
+    friend class MySharedPtr;
+
+    // Adopts a block that already counts this reference.
+    MySharedPtr(element_type* ptr, Counter<CountPolicy>* counter) : m_Ptr(ptr), m_Counter(counter) {}
+
+    // Only the owner that drops the count to zero deletes, reading GetCount() after Decrease() would race.
+    void Release()
+    {
+        if (m_Counter != nullptr && m_Counter->Decrease())
+        {
+            m_Counter->ReleaseObject();
+        }
+        m_Counter = nullptr; // Explicitly set to null after pointer deletion.
+        m_Ptr = nullptr; // Explicitly set to null after pointer deletion
+    }
+
+    element_type* m_Ptr; // Differs from the block's object when aliased
+    Counter<CountPolicy>* m_Counter; // Must be pointer, otherwise count is not sharable. If make static, it can only trace 1 type.
+};
+
+template <typename T, typename CountPolicy>
+void swap(MySharedPtr<T, CountPolicy>& lhs, MySharedPtr<T, CountPolicy>& rhs) noexcept
+{
+    lhs.swap(rhs);
+}
+
+// Non-owning reference to a MySharedPtr object. It keeps the control block alive so the
+// counts stay readable, but not the object, which lock() refuses to hand out once expired.
+template <typename T, typename CountPolicy>
+class MyWeakPtr
+{
+public:
+    MyWeakPtr() : m_Ptr(nullptr), m_Counter(nullptr) {}
+
+    MyWeakPtr(const MySharedPtr<T, CountPolicy>& shared) : m_Ptr(shared.m_Ptr), m_Counter(shared.m_Counter)
+    {
+        if (m_Counter != nullptr)
+        {
+            m_Counter->IncreaseWeak();
+        }
+    }
+
+    MyWeakPtr(const MyWeakPtr<T, CountPolicy>& other) : m_Ptr(other.m_Ptr), m_Counter(other.m_Counter)
+    {
+        if (m_Counter != nullptr)
+        {
+            m_Counter->IncreaseWeak();
+        }
+    }
+
+    MyWeakPtr(MyWeakPtr<T, CountPolicy>&& other) noexcept : m_Ptr(other.m_Ptr), m_Counter(other.m_Counter)
+    {
+        other.m_Ptr = nullptr;
+        other.m_Counter = nullptr;
+    }
+
+    ~MyWeakPtr()
+    {
+        reset();
+    }
+
+    MyWeakPtr<T, CountPolicy>& operator=(const MyWeakPtr<T, CountPolicy>& other)
+    {
+        MyWeakPtr<T, CountPolicy>(other).swap(*this);
+        return *this;
+    }
+
+    MyWeakPtr<T, CountPolicy>& operator=(MyWeakPtr<T, CountPolicy>&& other) noexcept
+    {
+        MyWeakPtr<T, CountPolicy>(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    MyWeakPtr<T, CountPolicy>& operator=(const MySharedPtr<T, CountPolicy>& shared)
+    {
+        MyWeakPtr<T, CountPolicy>(shared).swap(*this);
+        return *this;
+    }
+
+    // Returns an empty pointer if the object is already gone.
+    MySharedPtr<T, CountPolicy> lock() const
+    {
+        if (m_Counter != nullptr && m_Counter->IncreaseIfNotZero())
+        {
+            return MySharedPtr<T, CountPolicy>(m_Ptr, m_Counter);
+        }
+        return MySharedPtr<T, CountPolicy>();
+    }
+
+    bool expired() const
+    {
+        return m_Counter == nullptr || m_Counter->GetCount() == 0;
+    }
+
+    void reset() noexcept
+    {
+        if (m_Counter != nullptr)
+        {
+            m_Counter->ReleaseWeak();
+        }
+        m_Counter = nullptr;
+        m_Ptr = nullptr;
+    }
+
+    void swap(MyWeakPtr<T, CountPolicy>& other) noexcept
+    {
+        std::swap(m_Ptr, other.m_Ptr);
+        std::swap(m_Counter, other.m_Counter);
+    }
+
+    int GetCount() const
+    {
+        return m_Counter != nullptr ? m_Counter->GetCount() : 0;
+    }
+
+    int GetWeakCount() const
+    {
+        return m_Counter != nullptr ? m_Counter->GetWeakCount() : 0;
+    }
+
+private:
+    typename MySharedPtr<T, CountPolicy>::element_type* m_Ptr; // Only dereferenced through lock()
+    Counter<CountPolicy>* m_Counter;
+};
+
+// Shared by the factories, caller is their return address for tracing.
+template <typename T, typename CountPolicy, typename Alloc, typename... Args>
+MySharedPtr<T, CountPolicy> AllocateMySharedFor(const void* caller, const Alloc& alloc, Args&&... args)
+{
+    static_assert(!std::is_array<T>::value, "Arrays are owned through MySharedPtr<T[]>(new T[n])");
+    using Block = InplaceCounter<T, Alloc, CountPolicy>;
+    Block* counter = CreateBlock<Block>(alloc, alloc, std::forward<Args>(args)...);
+    counter->Trace(typeid(T), MyTraceSite{ nullptr, 0, caller });
+    // Passed as the base type, a Block* would pick the deleter constructor.
+    return MySharedPtr<T, CountPolicy>(counter->GetObject(), static_cast<Counter<CountPolicy>*>(counter));
+}
+
+// Allocates the object and its count in a single block from alloc, see InplaceCounter.
+template <typename T, typename CountPolicy, typename Alloc, typename... Args>
+MYSHAREDPTR_TRACE_NOINLINE MySharedPtr<T, CountPolicy> AllocateMyShared(const Alloc& alloc, Args&&... args)
+{
+    return AllocateMySharedFor<T, CountPolicy>(MYSHAREDPTR_TRACE_CALLER, alloc, std::forward<Args>(args)...);
+}
+
+template <typename T, typename CountPolicy, typename... Args>
+MYSHAREDPTR_TRACE_NOINLINE MySharedPtr<T, CountPolicy> MakeMyShared(Args&&... args)
+{
+    return AllocateMySharedFor<T, CountPolicy>(MYSHAREDPTR_TRACE_CALLER, std::allocator<T>(), std::forward<Args>(args)...);
+}
+
+// Slot holding a MySharedPtr that can be loaded and replaced concurrently without a lock,
+// for publishing immutable snapshots from a writer to many readers.
+// Split reference counts: the control block pointer and a 16 bit external count share one
+// 64 bit word. A reader first bumps the external count, which pins the block, then takes a
+// strong reference and pays the pin back: on the word if the block is still there, otherwise
+// on the strong count. A writer pins the block the same way, credits every other pin to the
+// strong count and only then swaps the word, so a reader that finds its block gone always
+// finds its pin already credited, and the strong count cannot reach zero while anyone still
+// holds a pin or a reference.
+// Only the AtomicCount policy qualifies, other threads release what the writer transferred.
+template <typename T>
+class MyAtomicSharedPtr
 {
 public:
-    Counter() 
+    MyAtomicSharedPtr() : m_Word(0) {}
+
+    explicit MyAtomicSharedPtr(MySharedPtr<T> desired) : m_Word(Adopt(desired)) {}
+
+    ~MyAtomicSharedPtr()
+    {
+        MySharedPtr<T> released = Detach(m_Word.load(std::memory_order_relaxed));
+    }
+
+    MyAtomicSharedPtr(const MyAtomicSharedPtr<T>&) = delete;
+    MyAtomicSharedPtr<T>& operator=(const MyAtomicSharedPtr<T>&) = delete;
+
+    MySharedPtr<T> load() const
+    {
+        uint64_t word = m_Word.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            if (GetBlock(word) == nullptr)
+            {
+                return MySharedPtr<T>();
+            }
+            if (GetExternal(word) == MAX_EXTERNAL)
+            {
+                // Too many readers mid-load, wait for some of them to pay back.
+                std::this_thread::yield();
+                word = m_Word.load(std::memory_order_relaxed);
+                continue;
+            }
+            // Acquire pairs with the writer's exchange, so the published object is visible.
+            if (m_Word.compare_exchange_weak(word, word + 1, std::memory_order_acquire, std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+
+        uint64_t pinned = word + 1;
+        Counter<AtomicCount>* block = GetBlock(pinned);
+        block->Increase();
+
+        // Pay back the pin where it currently lives. Failing here means the word changed, and the
+        // acquire pairs with the writer's swap, so its credit for our pin is already on the count.
+        uint64_t current = pinned;
+        while (GetBlock(current) == block && GetExternal(current) > 0)
+        {
+            if (m_Word.compare_exchange_weak(current, current - 1, std::memory_order_acquire, std::memory_order_acquire))
+            {
+                return MySharedPtr<T>(static_cast<T*>(block->GetManagedObject()), block);
+            }
+        }
+        // Settles the credited pin. Cannot reach zero, this load still holds the reference taken above.
+        block->Decrease();
+        return MySharedPtr<T>(static_cast<T*>(block->GetManagedObject()), block);
+    }
+
+    void store(MySharedPtr<T> desired)
+    {
+        exchange(std::move(desired));
+    }
+
+    MySharedPtr<T> exchange(MySharedPtr<T> desired)
+    {
+        MySharedPtr<T> previous;
+        Replace(Adopt(desired), nullptr, previous);
+        return previous;
+    }
+
+    // Compares the managed block only, like std::atomic<std::shared_ptr>. On failure expected
+    // receives the current value, on success desired is moved into the slot.
+    bool compare_exchange_strong(MySharedPtr<T>& expected, MySharedPtr<T> desired)
+    {
+        Counter<AtomicCount>* expectedBlock = expected.m_Counter;
+        MySharedPtr<T> previous;
+        if (Replace(Pack(desired.m_Counter), &expectedBlock, previous))
+        {
+            // The slot now owns desired's reference, previous drops the one it held on expected's block.
+            desired.m_Counter = nullptr;
+            desired.m_Ptr = nullptr;
+            return true;
+        }
+        expected = load();
+        return false;
+    }
+
+    bool compare_exchange_weak(MySharedPtr<T>& expected, MySharedPtr<T> desired)
+    {
+        return compare_exchange_strong(expected, std::move(desired));
+    }
+
+    bool is_lock_free() const
+    {
+        return m_Word.is_lock_free();
+    }
+
+private:
+    static_assert(sizeof(void*) == sizeof(uint64_t), "The block pointer is packed into 48 bits of a 64 bit word");
+
+    static constexpr int EXTERNAL_BITS = 16;
+    static constexpr uint64_t MAX_EXTERNAL = (uint64_t(1) << EXTERNAL_BITS) - 1;
+
+    static uint64_t Pack(Counter<AtomicCount>* block)
+    {
+        uint64_t address = reinterpret_cast<uintptr_t>(block);
+        assert((address >> (64 - EXTERNAL_BITS)) == 0);
+        return address << EXTERNAL_BITS;
+    }
+
+    static Counter<AtomicCount>* GetBlock(uint64_t word)
+    {
+        return reinterpret_cast<Counter<AtomicCount>*>(static_cast<uintptr_t>(word >> EXTERNAL_BITS));
+    }
+
+    static uint64_t GetExternal(uint64_t word)
+    {
+        return word & MAX_EXTERNAL;
+    }
+
+    // Moves desired's reference into a packed word. Only the block is stored, so aliased pointers
+    // are refused: load() could not recover where they pointed.
+    static uint64_t Adopt(MySharedPtr<T>& desired)
+    {
+        assert(desired.m_Counter == nullptr || desired.m_Ptr == desired.m_Counter->GetManagedObject());
+        uint64_t word = Pack(desired.m_Counter);
+        desired.m_Counter = nullptr;
+        desired.m_Ptr = nullptr;
+        return word;
+    }
+
+    // Swaps replacement into the slot, when expected is given only while the slot still holds
+    // that block, and hands the reference the slot held to previous.
+    // The outgoing block is pinned first so it stays alive while the other pins in the word are
+    // credited to its strong count. The swap only succeeds if the word is unchanged since the
+    // credit, so every pin is credited exactly once and before any reader can see the block gone.
+    bool Replace(uint64_t replacement, Counter<AtomicCount>* const* expected, MySharedPtr<T>& previous)
+    {
+        uint64_t current = m_Word.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            Counter<AtomicCount>* block = GetBlock(current);
+            if (expected != nullptr && block != *expected)
+            {
+                return false;
+            }
+
+            if (block == nullptr)
+            {
+                if (m_Word.compare_exchange_weak(current, replacement, std::memory_order_acq_rel, std::memory_order_relaxed))
+                {
+                    previous = MySharedPtr<T>();
+                    return true;
+                }
+                continue;
+            }
+
+            if (GetExternal(current) == MAX_EXTERNAL)
+            {
+                std::this_thread::yield();
+                current = m_Word.load(std::memory_order_relaxed);
+                continue;
+            }
+            if (!m_Word.compare_exchange_weak(current, current + 1, std::memory_order_acquire, std::memory_order_relaxed))
+            {
+                continue;
+            }
+            current += 1;
+
+            while (GetBlock(current) == block)
+            {
+                // Our own pin needs no credit, we settle it ourselves.
+                int credit = static_cast<int>(GetExternal(current)) - 1;
+                block->Add(credit);
+                if (m_Word.compare_exchange_weak(current, replacement, std::memory_order_acq_rel, std::memory_order_acquire))
+                {
+                    previous = MySharedPtr<T>(static_cast<T*>(block->GetManagedObject()), block);
+                    return true;
+                }
+                // Cannot reach zero: our pin is still in the word, or was credited by whoever swapped it out.
+                block->Add(-credit);
+            }
+
+            // Another writer swapped the block out and credited our pin, which leaves us owning a reference.
+            MySharedPtr<T> settled(static_cast<T*>(block->GetManagedObject()), block);
+        }
+    }
+
+    // Turns the word of a slot being destroyed back into an owning pointer. Nothing can race
+    // with the destructor, so readers still counted in the word simply move to the strong count.
+    static MySharedPtr<T> Detach(uint64_t word)
     {
-        m_Count = 1; 
-    } 
-    ~Counter() {}
+        Counter<AtomicCount>* block = GetBlock(word);
+        if (block == nullptr)
+        {
+            return MySharedPtr<T>();
+        }
+        uint64_t external = GetExternal(word);
+        if (external > 0)
+        {
+            block->Add(static_cast<int>(external));
+        }
+        return MySharedPtr<T>(static_cast<T*>(block->GetManagedObject()), block);
+    }
 
-    void Increase()
+    mutable std::atomic<uint64_t> m_Word;
+};
+
+// Base for objects that carry their own count, found by MyIntrusivePtr through the
+// IntrusiveAddRef/IntrusiveRelease customization points. Types that cannot inherit can
+// provide those two functions themselves, found by argument-dependent lookup.
+// The last release deletes through Derived, so no virtual destructor is needed and a
+// class operator delete on Derived (e.g. MyPoolAllocated) recycles the storage.
+template <typename Derived>
+class MyRefCounted
+{
+public:
+    int GetRefCount() const
     {
-        m_Count++;
+        return m_RefCount.load(std::memory_order_relaxed);
     }
 
-    void Decrease()
+protected:
+    MyRefCounted() {}
+    MyRefCounted(const MyRefCounted&) {} // A copy is a new object with no owners yet
+    MyRefCounted& operator=(const MyRefCounted&) { return *this; }
+    ~MyRefCounted() {}
+
+private:
+    // Same ordering as AtomicCount::Increase and AtomicCount::Decrease.
+    friend void IntrusiveAddRef(const Derived* object)
     {
-        m_Count--;
+        static_cast<const MyRefCounted*>(object)->m_RefCount.fetch_add(1, std::memory_order_relaxed);
     }
 
-    int GetCount()
+    friend void IntrusiveRelease(const Derived* object)
     {
-        return m_Count;
+        if (static_cast<const MyRefCounted*>(object)->m_RefCount.fetch_sub(1, std::memory_order_release) == 1)
+        {
+            std::atomic_thread_fence(std::memory_order_acquire);
+            delete object;
+        }
     }
 
-private:
-    int m_Count = 0;
+    mutable std::atomic<int> m_RefCount{ 0 };
 };
 
-template <typename T> 
-class MySharedPtr
+// One-word shared handle, the count lives inside T and shares its cache line.
+template <typename T>
+class MyIntrusivePtr
 {
 public:
-    MySharedPtr() : m_Ptr(nullptr), m_Counter(nullptr) {} // Default initializers
-    explicit MySharedPtr(T* ptr) : m_Ptr(ptr), m_Counter(new Counter()) {} // Explicitly initializer
-    ~MySharedPtr()
+    MyIntrusivePtr() : m_Ptr(nullptr) {}
+
+    // addRef = false adopts a reference the caller already counted.
+    explicit MyIntrusivePtr(T* ptr, bool addRef = true) : m_Ptr(ptr)
     {
-        if (m_Counter != nullptr)
+        if (m_Ptr != nullptr && addRef)
         {
-            m_Counter->Decrease();
-            if (m_Counter->GetCount() == 0)
-            {
-                delete m_Counter;
-                delete m_Ptr;
-                m_Counter = nullptr; // Explicitly set to null after pointer deletion.
-                m_Ptr = nullptr; // Explicitly set to null after pointer deletion
-            }
+            IntrusiveAddRef(m_Ptr);
         }
     }
 
-    // This is a sp(otherSharedPtr) call, creating a new reference
-    MySharedPtr(const MySharedPtr<T>& other)
+    MyIntrusivePtr(const MyIntrusivePtr<T>& other) : m_Ptr(other.m_Ptr)
     {
-        // This is shallow copy and it is intended
-        m_Ptr = other.m_Ptr;
-        m_Counter = other.m_Counter;
+        if (m_Ptr != nullptr)
+        {
+            IntrusiveAddRef(m_Ptr);
+        }
+    }
 
-        m_Counter->Increase();
+    MyIntrusivePtr(MyIntrusivePtr<T>&& other) noexcept : m_Ptr(other.m_Ptr)
+    {
+        other.m_Ptr = nullptr;
     }
 
-    // This is a copy constructor
-    const MySharedPtr<T>& operator=(const MySharedPtr<T>& other)
+    ~MyIntrusivePtr()
     {
-        if (m_Ptr != other.m_Ptr)
+        if (m_Ptr != nullptr)
         {
-            m_Ptr = other.m_Ptr;
-            m_Counter = other.m_Counter;
-            m_Counter->Increase();
+            IntrusiveRelease(m_Ptr);
         }
+    }
 
+    MyIntrusivePtr<T>& operator=(const MyIntrusivePtr<T>& other)
+    {
+        MyIntrusivePtr<T>(other).swap(*this);
+        return *this;
+    }
+
+    MyIntrusivePtr<T>& operator=(MyIntrusivePtr<T>&& other) noexcept
+    {
+        MyIntrusivePtr<T>(std::move(other)).swap(*this);
         return *this;
     }
 
+    void swap(MyIntrusivePtr<T>& other) noexcept
+    {
+        std::swap(m_Ptr, other.m_Ptr);
+    }
 
-    T* get()
+    void reset()
     {
-        return m_Ptr;
+        MyIntrusivePtr<T>().swap(*this);
     }
 
-    T* operator->() 
+    void reset(T* ptr)
+    {
+        MyIntrusivePtr<T>(ptr).swap(*this);
+    }
+
+    T* get() const
     {
         return m_Ptr;
     }
 
-    T& operator*() 
+    T* operator->() const
     {
-        return *m_Ptr;
+        return m_Ptr;
     }
 
-    int GetCount()
+    T& operator*() const
     {
-        // When MySharedPtr<T> is called, accessing the counter is 0. It is technically not shared yet.
-        return m_Counter != nullptr ? m_Counter->GetCount() : 0;
+        return *m_Ptr;
     }
 
 private:
-    T* m_Ptr;   
-    Counter* m_Counter; // Must be pointer, otherwise count is not sharable. If make static, it can only trace 1 type.
+    T* m_Ptr;
 };
 
+template <typename T, typename... Args>
+MyIntrusivePtr<T> MakeMyIntrusive(Args&&... args)
+{
+    return MyIntrusivePtr<T>(new T(std::forward<Args>(args)...));
+}
+
 class Test
 {
     int value { 23 };
     std::string str { "sharedptr" };
 };
+
+// Same payload as Test, with an embedded count and pooled storage.
+class IntrusiveTest : public MyRefCounted<IntrusiveTest>, public MyPoolAllocated<IntrusiveTest>
+{
+    int value { 23 };
+    std::string str { "sharedptr" };
+};
  
-int main()
+namespace MySharedPtrBenchmark
+{
+    // Every thread copies and destroys handles to the same object, so all of them hammer one counter.
+    // Returns nanoseconds per copy + destroy pair.
+    template <typename Ptr>
+    double MeasureCopyDestroy(const Ptr& shared, int threadCount, int iterations)
+    {
+        std::atomic<int> ready{ 0 };
+        std::atomic<bool> go{ false };
+        std::vector<std::thread> threads;
+
+        for (int t = 0; t < threadCount; ++t)
+        {
+            threads.emplace_back([&]
+                {
+                    ready.fetch_add(1);
+                    while (!go.load(std::memory_order_acquire))
+                    {
+                        std::this_thread::yield();
+                    }
+
+                    for (int i = 0; i < iterations; ++i)
+                    {
+                        Ptr copy(shared);
+                    }
+                });
+        }
+
+        while (ready.load() != threadCount)
+        {
+            std::this_thread::yield();
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        go.store(true, std::memory_order_release);
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+        return static_cast<double>(elapsed.count()) / (static_cast<double>(threadCount) * iterations);
+    }
+
+    // Create and drop one pointer at a time, so the cost is dominated by the allocator.
+    template <typename Factory>
+    double MeasureCreateDestroy(Factory factory, int iterations)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i)
+        {
+            auto ptr = factory();
+        }
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+        return static_cast<double>(elapsed.count()) / iterations;
+    }
+
+    void RunAllocation(int iterations = 1000000)
+    {
+        std::cout << "create+destroy (ns/op)" << std::endl;
+        std::cout << "MySharedPtr(new T)  " << MeasureCreateDestroy([] { return MySharedPtr<Test>(new Test()); }, iterations) << std::endl;
+        std::cout << "MySharedPtr(pooled) " << MeasureCreateDestroy([] { return MySharedPtr<Test>(new Test(), std::default_delete<Test>(), MyPoolAllocator<Test>()); }, iterations) << std::endl;
+        std::cout << "MakeMyShared<T>     " << MeasureCreateDestroy([] { return MakeMyShared<Test>(); }, iterations) << std::endl;
+        std::cout << "AllocateMyShared<T> " << MeasureCreateDestroy([] { return AllocateMyShared<Test>(MyPoolAllocator<Test>()); }, iterations) << std::endl;
+        std::cout << "std::make_shared<T> " << MeasureCreateDestroy([] { return std::make_shared<Test>(); }, iterations) << std::endl;
+        std::cout << "MakeMyIntrusive<T>  " << MeasureCreateDestroy([] { return MakeMyIntrusive<IntrusiveTest>(); }, iterations) << std::endl;
+    }
+
+    // Growing a vector without reserve relocates every element on each reallocation.
+    // With a noexcept move that is a pointer copy, without it every relocation is a count round trip.
+    template <typename Ptr>
+    double MeasureVectorGrowth(const Ptr& shared, int count)
+    {
+        auto start = std::chrono::steady_clock::now();
+        {
+            std::vector<Ptr> pointers;
+            for (int i = 0; i < count; ++i)
+            {
+                pointers.push_back(shared);
+            }
+            std::rotate(pointers.begin(), pointers.begin() + pointers.size() / 2, pointers.end());
+        }
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+        return static_cast<double>(elapsed.count()) / count;
+    }
+
+    void RunVectorGrowth(int count = 1000000)
+    {
+        MySharedPtr<Test> mine = MakeMyShared<Test>();
+        std::shared_ptr<Test> standard = std::make_shared<Test>();
+
+        std::cout << "vector push_back+rotate (ns/element)" << std::endl;
+        std::cout << "MySharedPtr      " << MeasureVectorGrowth(mine, count) << std::endl;
+        std::cout << "std::shared_ptr  " << MeasureVectorGrowth(standard, count) << std::endl;
+    }
+
+    // Copies and destroys on the calling thread only, the pattern NonAtomicCount and the biased owner path target.
+    template <typename Ptr>
+    double MeasureLocalCopyDestroy(const Ptr& shared, int iterations)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i)
+        {
+            Ptr copy(shared);
+        }
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+        return static_cast<double>(elapsed.count()) / iterations;
+    }
+
+    void RunCountPolicies(int iterations = 10000000)
+    {
+        MySharedPtr<Test, NonAtomicCount> nonAtomic = MakeMyShared<Test, NonAtomicCount>();
+        MySharedPtr<Test, AtomicCount> atomic = MakeMyShared<Test, AtomicCount>();
+        MySharedPtr<Test, BiasedCount> biased = MakeMyShared<Test, BiasedCount>();
+
+        std::cout << "owner thread copy+destroy (ns/op)" << std::endl;
+        std::cout << "NonAtomicCount  " << MeasureLocalCopyDestroy(nonAtomic, iterations) << std::endl;
+        std::cout << "AtomicCount     " << MeasureLocalCopyDestroy(atomic, iterations) << std::endl;
+        std::cout << "BiasedCount     " << MeasureLocalCopyDestroy(biased, iterations) << std::endl;
+
+        // Every worker is a non-owner here, so the biased block pays for the shared path.
+        unsigned int threadCount = std::max(2u, std::thread::hardware_concurrency());
+        std::cout << "other threads (" << threadCount << ") copy+destroy (ns/op)" << std::endl;
+        std::cout << "AtomicCount     " << MeasureCopyDestroy(atomic, static_cast<int>(threadCount), iterations / 10) << std::endl;
+        std::cout << "BiasedCount     " << MeasureCopyDestroy(biased, static_cast<int>(threadCount), iterations / 10) << std::endl;
+    }
+
+    // Readers take the current snapshot while one writer keeps publishing new ones.
+    // Returns nanoseconds per read.
+    template <typename Read, typename Write>
+    double MeasureSnapshotReads(Read read, Write write, int readerCount, int iterations)
+    {
+        std::atomic<bool> done{ false };
+        std::thread writer([&]
+            {
+                while (!done.load(std::memory_order_relaxed))
+                {
+                    write();
+                    std::this_thread::sleep_for(std::chrono::microseconds(10));
+                }
+            });
+
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> readers;
+        for (int r = 0; r < readerCount; ++r)
+        {
+            readers.emplace_back([&]
+                {
+                    for (int i = 0; i < iterations; ++i)
+                    {
+                        read();
+                    }
+                });
+        }
+        for (auto& reader : readers)
+        {
+            reader.join();
+        }
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+
+        done.store(true, std::memory_order_relaxed);
+        writer.join();
+        return static_cast<double>(elapsed.count()) / (static_cast<double>(readerCount) * iterations);
+    }
+
+    void RunSnapshotReaders(int iterations = 200000)
+    {
+        MyAtomicSharedPtr<Test> atomicSlot(MakeMyShared<Test>());
+        std::mutex mutex;
+        MySharedPtr<Test> lockedSlot = MakeMyShared<Test>();
+        std::shared_ptr<Test> standardSlot = std::make_shared<Test>();
+
+        std::cout << "readers  MyAtomicSharedPtr(ns/load)  mutex+MySharedPtr(ns/load)  std::atomic_load(ns/load)" << std::endl;
+        unsigned int maxThreads = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned int readerCount = 1; readerCount <= maxThreads; readerCount *= 2)
+        {
+            double atomicNs = MeasureSnapshotReads(
+                [&] { return atomicSlot.load().get(); },
+                [&] { atomicSlot.store(MakeMyShared<Test>()); },
+                static_cast<int>(readerCount), iterations);
+            double lockedNs = MeasureSnapshotReads(
+                [&] { std::lock_guard<std::mutex> lock(mutex); MySharedPtr<Test> copy = lockedSlot; return copy.get(); },
+                [&] { MySharedPtr<Test> next = MakeMyShared<Test>(); std::lock_guard<std::mutex> lock(mutex); lockedSlot.swap(next); },
+                static_cast<int>(readerCount), iterations);
+            double standardNs = MeasureSnapshotReads(
+                [&] { return std::atomic_load(&standardSlot).get(); },
+                [&] { std::atomic_store(&standardSlot, std::make_shared<Test>()); },
+                static_cast<int>(readerCount), iterations);
+            std::cout << readerCount << "  " << atomicNs << "  " << lockedNs << "  " << standardNs << std::endl;
+        }
+    }
+
+    // Snapshot that tracks how many instances are alive and poisons itself on destruction,
+    // so a reader holding a freed one or a block released twice shows up in the totals.
+    struct StressSnapshot
+    {
+        static constexpr int ALIVE = 0x5AFE;
+
+        explicit StressSnapshot(int version) : m_Version(version)
+        {
+            s_Live.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        ~StressSnapshot()
+        {
+            m_Canary = 0;
+            s_Live.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        int m_Canary = ALIVE;
+        int m_Version;
+        static std::atomic<int> s_Live;
+    };
+
+    std::atomic<int> StressSnapshot::s_Live{ 0 };
+
+    // Readers load and check the slot while writers replace it through store, exchange and
+    // compare_exchange, so blocks are swapped out under pinned readers as often as possible.
+    // Returns false if a reader saw a dead snapshot or instances leaked or were freed twice.
+    bool RunAtomicStress(int readerCount = 6, int writerCount = 2, int iterations = 200000)
+    {
+        std::atomic<int> failures{ 0 };
+        {
+            MyAtomicSharedPtr<StressSnapshot> slot(MakeMyShared<StressSnapshot>(0));
+            std::atomic<bool> done{ false };
+            std::vector<std::thread> threads;
+
+            for (int r = 0; r < readerCount; ++r)
+            {
+                threads.emplace_back([&]
+                    {
+                        while (!done.load(std::memory_order_acquire))
+                        {
+                            MySharedPtr<StressSnapshot> snapshot = slot.load();
+                            MySharedPtr<StressSnapshot> copy = snapshot;
+                            if (snapshot.get() == nullptr || snapshot->m_Canary != StressSnapshot::ALIVE || copy.GetCount() < 2)
+                            {
+                                failures.fetch_add(1, std::memory_order_relaxed);
+                            }
+                        }
+                    });
+            }
+
+            std::vector<std::thread> writers;
+            for (int w = 0; w < writerCount; ++w)
+            {
+                writers.emplace_back([&, w]
+                    {
+                        for (int i = 1; i <= iterations; ++i)
+                        {
+                            int version = w * iterations + i;
+                            switch (i % 3)
+                            {
+                            case 0:
+                                slot.store(MakeMyShared<StressSnapshot>(version));
+                                break;
+                            case 1:
+                            {
+                                MySharedPtr<StressSnapshot> previous = slot.exchange(MakeMyShared<StressSnapshot>(version));
+                                if (previous.get() == nullptr || previous->m_Canary != StressSnapshot::ALIVE)
+                                {
+                                    failures.fetch_add(1, std::memory_order_relaxed);
+                                }
+                                break;
+                            }
+                            default:
+                            {
+                                MySharedPtr<StressSnapshot> expected = slot.load();
+                                slot.compare_exchange_strong(expected, MakeMyShared<StressSnapshot>(version));
+                                break;
+                            }
+                            }
+                        }
+                    });
+            }
+
+            for (auto& writer : writers)
+            {
+                writer.join();
+            }
+            done.store(true, std::memory_order_release);
+            for (auto& thread : threads)
+            {
+                thread.join();
+            }
+        }
+
+        int leaked = StressSnapshot::s_Live.load();
+        std::cout << "atomic stress: " << readerCount << " readers, " << writerCount << " writers, "
+            << failures.load() << " bad loads, " << leaked << " snapshots alive after teardown" << std::endl;
+        return failures.load() == 0 && leaked == 0;
+    }
+
+    // Time spent in the thread that drops the last reference to a large graph.
+    template <typename CountPolicy>
+    double MeasureTeardown(int children)
+    {
+        using Children = std::vector<MySharedPtr<Test, CountPolicy>>;
+        MySharedPtr<Children, CountPolicy> root = MakeMyShared<Children, CountPolicy>();
+        for (int i = 0; i < children; ++i)
+        {
+            root->push_back(MakeMyShared<Test, CountPolicy>());
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        root.reset();
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+        return static_cast<double>(elapsed.count());
+    }
+
+    void RunDeferredTeardown(int children = 1000000)
+    {
+        std::cout << "last release of " << children << " children (us on releasing thread)" << std::endl;
+        std::cout << "inline    " << MeasureTeardown<AtomicCount>(children) << std::endl;
+        std::cout << "deferred  " << MeasureTeardown<DeferredReclaim<AtomicCount>>(children) << std::endl;
+        EpochReclaimer::Get().Synchronize();
+    }
+
+    // Suite for --bench suite: copy and assign throughput of MySharedPtr against std::shared_ptr,
+    // across thread counts, sharing patterns and object sizes.
+
+    enum class ESharing
+    {
+        SHARED,           // Every thread uses the same two objects, true sharing of one count
+        PRIVATE_ADJACENT, // Own objects per thread, blocks packed next to each other by the pool
+        PRIVATE_PADDED,   // Own objects per thread, each block on its own cache line
+        INLINE_SMALL,     // Own objects per thread, count and small object in one block
+        INLINE_LARGE,     // Same with a 1KB object, which keeps the counts apart
+    };
+
+    enum class EPointerOp
+    {
+        COPY,   // Copy construct then destroy
+        ASSIGN, // Alternate a local pointer between two objects
+    };
+
+    struct LargePayload
+    {
+        char data[1024] = {};
+    };
+
+    // Rounds every allocation up to whole cache lines, so no two blocks share one.
+    template <typename T>
+    class CacheLineAllocator
+    {
+    public:
+        using value_type = T;
+
+        CacheLineAllocator() noexcept {}
+
+        template <typename U>
+        CacheLineAllocator(const CacheLineAllocator<U>&) noexcept {}
+
+        T* allocate(std::size_t count)
+        {
+            return static_cast<T*>(::operator new(RoundUp(count * sizeof(T)), std::align_val_t(CACHE_LINE)));
+        }
+
+        void deallocate(T* ptr, std::size_t count)
+        {
+            ::operator delete(ptr, RoundUp(count * sizeof(T)), std::align_val_t(CACHE_LINE));
+        }
+
+    private:
+        static constexpr std::size_t CACHE_LINE = 64;
+
+        static std::size_t RoundUp(std::size_t size)
+        {
+            return (size + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE;
+        }
+    };
+
+    template <typename T, typename U>
+    bool operator==(const CacheLineAllocator<T>&, const CacheLineAllocator<U>&)
+    {
+        return true;
+    }
+
+    template <typename T, typename U>
+    bool operator!=(const CacheLineAllocator<T>&, const CacheLineAllocator<U>&)
+    {
+        return false;
+    }
+
+    // Thread t works on sources[2t] and sources[2t + 1], wrapped around for the shared pattern.
+    // Returns nanoseconds per operation.
+    template <typename Ptr>
+    double MeasurePattern(const std::vector<Ptr>& sources, EPointerOp op, int threadCount, int iterations)
+    {
+        std::atomic<int> ready{ 0 };
+        std::atomic<bool> go{ false };
+        std::vector<std::thread> threads;
+
+        for (int t = 0; t < threadCount; ++t)
+        {
+            const Ptr& first = sources[(2 * t) % sources.size()];
+            const Ptr& second = sources[(2 * t + 1) % sources.size()];
+            threads.emplace_back([&, op]
+                {
+                    ready.fetch_add(1);
+                    while (!go.load(std::memory_order_acquire))
+                    {
+                        std::this_thread::yield();
+                    }
+
+                    if (op == EPointerOp::COPY)
+                    {
+                        for (int i = 0; i < iterations; ++i)
+                        {
+                            Ptr copy(first);
+                        }
+                        return;
+                    }
+
+                    Ptr local;
+                    for (int i = 0; i < iterations; ++i)
+                    {
+                        local = (i & 1) ? second : first;
+                    }
+                });
+        }
+
+        while (ready.load() != threadCount)
+        {
+            std::this_thread::yield();
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        go.store(true, std::memory_order_release);
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+        return static_cast<double>(elapsed.count()) / (static_cast<double>(threadCount) * iterations);
+    }
+
+    // Builds the objects of one pattern, created back to back so the pool places them next to each other.
+    template <typename Mine, typename Standard>
+    void MakeSources(ESharing sharing, int count, std::vector<Mine>& mine, std::vector<Standard>& standard)
+    {
+        using Payload = typename Mine::element_type;
+        for (int i = 0; i < count; ++i)
+        {
+            switch (sharing)
+            {
+            case ESharing::SHARED:
+            case ESharing::PRIVATE_ADJACENT:
+                mine.emplace_back(new Payload(), std::default_delete<Payload>(), MyPoolAllocator<Payload>());
+                standard.emplace_back(new Payload(), std::default_delete<Payload>(), MyPoolAllocator<Payload>());
+                break;
+            case ESharing::PRIVATE_PADDED:
+                mine.emplace_back(new Payload(), std::default_delete<Payload>(), CacheLineAllocator<Payload>());
+                standard.emplace_back(new Payload(), std::default_delete<Payload>(), CacheLineAllocator<Payload>());
+                break;
+            case ESharing::INLINE_SMALL:
+            case ESharing::INLINE_LARGE:
+                mine.push_back(MakeMyShared<Payload>());
+                standard.push_back(std::make_shared<Payload>());
+                break;
+            }
+        }
+    }
+
+    template <typename Payload>
+    void RunPattern(const char* name, ESharing sharing, unsigned int maxThreads, int iterations)
+    {
+        for (unsigned int threadCount = 1; threadCount <= maxThreads; threadCount *= 2)
+        {
+            int count = sharing == ESharing::SHARED ? 2 : static_cast<int>(2 * threadCount);
+            std::vector<MySharedPtr<Payload>> mine;
+            std::vector<std::shared_ptr<Payload>> standard;
+            mine.reserve(count);
+            standard.reserve(count);
+            MakeSources(sharing, count, mine, standard);
+
+            for (EPointerOp op : { EPointerOp::COPY, EPointerOp::ASSIGN })
+            {
+                double mineNs = MeasurePattern(mine, op, static_cast<int>(threadCount), iterations);
+                double standardNs = MeasurePattern(standard, op, static_cast<int>(threadCount), iterations);
+                std::cout << name << "  " << (op == EPointerOp::COPY ? "copy" : "assign") << "  " << threadCount
+                    << "  " << mineNs << "  " << standardNs << "  " << standardNs / mineNs << std::endl;
+            }
+        }
+    }
+
+    void RunSuite(int iterations = 1000000)
+    {
+        unsigned int maxThreads = std::max(1u, std::thread::hardware_concurrency());
+        std::cout << "pattern  op  threads  MySharedPtr(ns/op)  std::shared_ptr(ns/op)  speedup" << std::endl;
+        RunPattern<Test>("shared", ESharing::SHARED, maxThreads, iterations);
+        RunPattern<Test>("private-adjacent", ESharing::PRIVATE_ADJACENT, maxThreads, iterations);
+        RunPattern<Test>("private-padded", ESharing::PRIVATE_PADDED, maxThreads, iterations);
+        RunPattern<Test>("inline-small", ESharing::INLINE_SMALL, maxThreads, iterations);
+        RunPattern<LargePayload>("inline-large", ESharing::INLINE_LARGE, maxThreads, iterations);
+    }
+
+    void RunContention(int iterations = 1000000)
+    {
+        MySharedPtr<Test> mine(new Test());
+        std::shared_ptr<Test> standard = std::make_shared<Test>();
+        MyIntrusivePtr<IntrusiveTest> intrusive = MakeMyIntrusive<IntrusiveTest>();
+
+        std::cout << "threads  MySharedPtr(ns/op)  std::shared_ptr(ns/op)  MyIntrusivePtr(ns/op)" << std::endl;
+        unsigned int maxThreads = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned int threadCount = 1; threadCount <= maxThreads * 2; threadCount *= 2)
+        {
+            double mineNs = MeasureCopyDestroy(mine, static_cast<int>(threadCount), iterations);
+            double standardNs = MeasureCopyDestroy(standard, static_cast<int>(threadCount), iterations);
+            double intrusiveNs = MeasureCopyDestroy(intrusive, static_cast<int>(threadCount), iterations);
+            std::cout << threadCount << "  " << mineNs << "  " << standardNs << "  " << intrusiveNs << std::endl;
+        }
+    }
+}
+
+int main(int argc, char* argv[])
 {
+    if (argc > 1 && std::string(argv[1]) == "--stress")
+    {
+        return MySharedPtrBenchmark::RunAtomicStress() ? 0 : 1;
+    }
+    if (argc > 2 && std::string(argv[1]) == "--bench" && std::string(argv[2]) == "suite")
+    {
+        MySharedPtrBenchmark::RunSuite();
+        return 0;
+    }
+    if (argc > 1 && std::string(argv[1]) == "--bench")
+    {
+        // Contention first: libstdc++ uses plain increments until the process starts its first thread,
+        // which would flatter std::shared_ptr in the single threaded runs.
+        MySharedPtrBenchmark::RunContention();
+        MySharedPtrBenchmark::RunCountPolicies();
+        MySharedPtrBenchmark::RunSnapshotReaders();
+        MySharedPtrBenchmark::RunDeferredTeardown();
+        MySharedPtrBenchmark::RunAllocation();
+        MySharedPtrBenchmark::RunVectorGrowth();
+        return 0;
+    }
+
     MySharedPtr<Test> sp0;
     std::cout << "sp0: " <<  sp0.GetCount() << std::endl;
     {
@@ -121,6 +2453,83 @@ int main()
 
         sp0 = sp2;
         std::cout<< "sp0: " << sp0.GetCount() << std::endl;
+
+        MySharedPtr<Test> sp3 = MakeMyShared<Test>();
+        std::cout << "sp3: " << sp3.GetCount() << std::endl;
+
+        MySharedPtr<Test> sp4(std::move(sp3));
+        std::cout << "sp4: " << sp4.GetCount() << " sp3: " << sp3.GetCount() << std::endl;
+
+        sp4.reset();
+        std::cout << "sp4: " << sp4.GetCount() << std::endl;
+    }
+
+    MyWeakPtr<Test> wp0;
+    {
+        MySharedPtr<Test> sp5 = MakeMyShared<Test>();
+        wp0 = sp5;
+        std::cout << "wp0: " << wp0.GetCount() << " weak " << wp0.GetWeakCount() << " expired " << wp0.expired() << std::endl;
+
+        MySharedPtr<Test> sp6 = wp0.lock();
+        std::cout << "sp6: " << sp6.GetCount() << std::endl;
+    }
+    std::cout << "wp0: " << wp0.GetCount() << " expired " << wp0.expired() << " lock " << wp0.lock().GetCount() << std::endl;
+
+    {
+        MyIntrusivePtr<IntrusiveTest> ip0 = MakeMyIntrusive<IntrusiveTest>();
+        MyIntrusivePtr<IntrusiveTest> ip1(ip0);
+        std::cout << "ip1: " << ip1->GetRefCount() << " handle " << sizeof(ip1) << " bytes vs " << sizeof(MySharedPtr<Test>) << std::endl;
+    }
+    {
+        MySharedPtr<Test, NonAtomicCount> np0 = MakeMyShared<Test, NonAtomicCount>();
+        MySharedPtr<Test, NonAtomicCount> np1(np0);
+        std::cout << "np1: " << np1.GetCount() << std::endl;
+
+        // The copy is counted on this thread but dropped on another, the owner merges it on its next release.
+        MySharedPtr<Test, BiasedCount> bp0 = MakeMyShared<Test, BiasedCount>();
+        MySharedPtr<Test, BiasedCount> bp1(bp0);
+        std::thread([moved = std::move(bp1)]() mutable { moved.reset(); }).join();
+        std::cout << "bp0: " << bp0.GetCount() << std::endl;
+    }
+    {
+        // Object from a pool the caller owns, handed back by the deleter instead of delete.
+        FixedBlockPool arena(sizeof(Test), alignof(Test));
+        MySharedPtr<Test> sp7(new (arena.Allocate()) Test(), [&arena](Test* test) { test->~Test(); arena.Deallocate(test); });
+        MySharedPtr<Test> sp8 = AllocateMyShared<Test>(MyPoolAllocator<Test>());
+        std::cout << "sp7: " << sp7.GetCount() << " sp8: " << sp8.GetCount() << std::endl;
+    }
+
+    {
+        // Zero-copy view into a shared buffer, the buffer lives as long as the view.
+        MySharedPtr<int[]> buffer(new int[8]());
+        buffer[3] = 7;
+        MySharedPtr<int> slice(buffer, &buffer[2]);
+        buffer.reset();
+        std::cout << "slice: " << slice.GetCount() << " value " << slice.get()[1] << std::endl;
+
+        // Assigning between aliases of one owner repoints without touching the count.
+        MySharedPtr<int> other(slice, slice.get() + 1);
+        other.get()[0] = 9;
+        slice = other;
+        assert(*slice == 9 && slice.GetCount() == 2);
+        std::cout << "alias: " << slice.GetCount() << " value " << *slice << std::endl;
+    }
+
+    {
+        // Released on the reclaimer thread, the weak reference sees it expired right away.
+        MySharedPtr<Test, DeferredReclaim<>> dp0 = MakeMyShared<Test, DeferredReclaim<>>();
+        MyWeakPtr<Test, DeferredReclaim<>> dw0(dp0);
+        dp0.reset();
+        std::cout << "dw0: expired " << dw0.expired() << std::endl;
+        EpochReclaimer::Get().Synchronize();
+    }
+
+    {
+        MyAtomicSharedPtr<Test> ap0(MakeMyShared<Test>());
+        MySharedPtr<Test> snapshot = ap0.load();
+        MySharedPtr<Test> previous = ap0.exchange(MakeMyShared<Test>());
+        std::cout << "ap0: " << ap0.load().GetCount() << " previous " << previous.GetCount()
+            << " cas " << ap0.compare_exchange_strong(snapshot, MySharedPtr<Test>()) << std::endl;
     }
     std::cout << "sp0: " << sp0.GetCount() << std::endl;
     return 0;